@@ -39,7 +39,7 @@ public:
 
     void modifyObject(BRLCAD::Object* newObject);
 
-    RaytraceView * raytraceWidget;
+    RaytraceView * raytraceWidget = nullptr;
     // getters setters
     QString* getFilePath() const
     {
@@ -86,12 +86,16 @@ public:
 
     void setFilePath(const QString& filePath)
     {
-        this->filePath = new QString(filePath);
+        if (this->filePath != nullptr) *this->filePath = filePath;
+        else this->filePath = new QString(filePath);
     }
 
     bool isModified();
     bool Add(const BRLCAD::Object& object);
+    // the document is then saved to and unmodified in fileName
     bool Save(const char* fileName);
+    // writes the database without changing the document's file or modified state
+    bool SaveCopy(const char* fileName);
     void getBRLCADConstObject(const QString& objectName, const std::function<void(const BRLCAD::Object&)>& func) const;
     void getBRLCADObject(const QString& objectName, const std::function<void(BRLCAD::Object&)>& func);
 };
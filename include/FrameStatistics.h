@@ -0,0 +1,87 @@
+/*                 F R A M E S T A T I S T I C S . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file FrameStatistics.h */
+
+#ifndef BRLCAD_FRAMESTATISTICS_H
+#define BRLCAD_FRAMESTATISTICS_H
+
+#include <QElapsedTimer>
+#include <QOpenGLTimerQuery>
+#include <QPainter>
+#include "GeometryCache.h"
+
+/*
+ * Measures the frames of one viewport and paints them as an overlay: CPU and GPU time with a histogram of the
+ * recent frames, objects drawn, culled and occluded, vertices and draw calls submitted, and the GPU memory used by geometry.
+ *
+ * GPU time comes from timer queries, which finish a few frames later; a ring of queries is used so that reading
+ * them never stalls. Without timer query support only CPU time is shown.
+ * The viewport also measures its frames while the overlay is off, to decide when to reduce the detail.
+ * beginFrame() and endFrame() enclose the drawing and need the viewport's context to be current, so does deleting.
+ */
+class FrameStatistics {
+public:
+    FrameStatistics();
+
+    void beginFrame(const GeometryCache &geometryCache, bool reducedDetail);
+    void endFrame(const GeometryCache &geometryCache, int drawnObjectCount, int culledObjectCount,
+                  int occludedObjectCount);
+    void paint(QPainter &painter) const;
+    // the longer of CPU and GPU time of the latest full detail frame that has both, its CPU time without timer
+    // queries; 0 before any full detail frame
+    float latestFullDetailFrameMs() const;
+
+private:
+    static const int HISTORY_SIZE = 120;
+    static const int TIMER_QUERY_COUNT = 4;
+
+    QElapsedTimer cpuTimer;
+    // ring buffers of the recent frame times in milliseconds, -1 where not measured
+    float cpuHistory[HISTORY_SIZE];
+    float gpuHistory[HISTORY_SIZE];
+    bool reducedDetailHistory[HISTORY_SIZE] = {};
+    int historyFrameCount = 0;
+
+    QOpenGLTimerQuery timerQueries[TIMER_QUERY_COUNT];
+    // frame number a query measures, -1 if it is free
+    int timerQueryFrames[TIMER_QUERY_COUNT] = {-1, -1, -1, -1};
+    bool timerQueriesCreated = false;
+    bool timerQueriesSupported = false;
+    int runningTimerQuery = -1;
+
+    quint64 frameStartDrawCalls = 0;
+    quint64 frameStartIndices = 0;
+    quint64 drawCalls = 0;
+    quint64 submittedVertices = 0;
+    size_t usedBytes = 0;
+    size_t peakUsedBytes = 0;
+    size_t budgetBytes = 0;
+    size_t residentBytes = 0;
+    size_t peakResidentBytes = 0;
+    quint64 evictedCount = 0;
+    int drawnObjects = 0;
+    int culledObjects = 0;
+    int occludedObjects = 0;
+
+    void collectTimerQueries();
+};
+
+
+#endif //BRLCAD_FRAMESTATISTICS_H
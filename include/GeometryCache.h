@@ -0,0 +1,201 @@
+/*                   G E O M E T R Y C A C H E . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file GeometryCache.h */
+
+#ifndef BRLCAD_GEOMETRYCACHE_H
+#define BRLCAD_GEOMETRYCACHE_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <QOpenGLFunctions>
+#include "GeometryData.h"
+
+/*
+ * Keeps uploaded GeometryData in vertex and index buffers.
+ * Buffers are allocated in large pages and every object gets a range of vertices and a range of
+ * indices inside one page. Objects living in the same page can therefore be drawn together with a
+ * single glMultiDrawElements call per primitive type.
+ *
+ * Vertices are kept either as the floats of GeometryData or in the compact format, which takes half the memory:
+ * positions are quantized to 16 bits inside the object's bounding box and normals are octahedral encoded in two
+ * 16 bit values. The shader decodes them with the box of the entry, which is looked up in a table of the page, so
+ * compact entries can still be drawn together. Compact pages can only be drawn with ShaderAttributes.
+ *
+ * The bytes used by entries are kept below a budget shared by all documents (geometryBudgetMB setting) by
+ * enforceBudget(), which asks the owners of entries to evict what was drawn least recently. Owners upload evicted
+ * geometry again when they need it. Pages left empty are deleted then, or by the next enforceBudget() after
+ * release() emptied them, e.g. when a document is closed.
+ *
+ * upload(), bindPage(), draw() and enforceBudget() need a current OpenGL context. release() only returns the
+ * ranges to the page's free lists, so it can be called at any time.
+ */
+class GeometryCache {
+public:
+    enum VertexFormat {
+        FloatVertices,
+        CompactVertices
+    };
+
+    struct Entry {
+        int page = -1;
+        VertexFormat vertexFormat = FloatVertices;
+        // row of the entry's bounding box in the decode table of a compact page
+        int decodeSlot = -1;
+        GLint firstVertex = 0;
+        GLsizei vertexCount = 0;
+        GLint firstIndex[GeometryData::PrimitiveCount] = {0, 0, 0};
+        GLsizei indexCount[GeometryData::PrimitiveCount] = {0, 0, 0};
+
+        bool isValid() const;
+        GLsizei totalIndexCount() const;
+        size_t byteSize() const;
+    };
+
+    // how bindPage() feeds the vertices to the pipeline
+    enum VertexInput {
+        FixedFunctionArrays,
+        // position at attribute location 0, normal at 1, for compact vertices the decode slot at 2 and the
+        // decode table as a buffer texture on texture unit 0
+        ShaderAttributes
+    };
+
+    // geometry of an owner that enforceBudget() may evict
+    class Owner;
+    struct EvictionCandidate {
+        Owner *owner;
+        QString objectName;
+        // see timestamp()
+        qint64 lastDrawn;
+        size_t bytes;
+    };
+    class Owner {
+    public:
+        virtual ~Owner() = default;
+        virtual void collectEvictionCandidates(QVector<EvictionCandidate> &candidates) = 0;
+        // releases the entries of the candidate
+        virtual void evict(const EvictionCandidate &candidate) = 0;
+    };
+
+    GeometryCache();
+
+    Entry upload(const GeometryData &data, VertexFormat vertexFormat = FloatVertices);
+    void release(Entry &entry);
+
+    void addOwner(Owner *owner);
+    void removeOwner(Owner *owner);
+    // milliseconds on a clock shared by all owners, for EvictionCandidate::lastDrawn
+    qint64 timestamp() const {
+        return clock.elapsed();
+    }
+    // evicts the least recently drawn candidates until the used bytes are within the budget. Candidates drawn in
+    // the last EVICTION_MIN_AGE_MS are kept, so viewports of the same document do not evict each other's geometry
+    void enforceBudget();
+
+    void bindPage(int page, VertexInput vertexInput = FixedFunctionArrays);
+    void unbind();
+    // all entries have to live in the currently bound page
+    void draw(GeometryData::Primitive primitive, const QVector<const Entry *> &entries);
+    // draws the entry instanceCount times with one call, the instance attributes are up to the caller
+    void drawInstanced(GeometryData::Primitive primitive, const Entry &entry, GLsizei instanceCount);
+
+    // buffer memory allocated for the pages
+    size_t residentBytes() const;
+    size_t getPeakResidentBytes() const {
+        return peakResidentBytes;
+    }
+    // the part of the pages in use by entries
+    size_t getUsedBytes() const {
+        return usedBytes;
+    }
+    size_t getPeakUsedBytes() const {
+        return peakUsedBytes;
+    }
+    size_t getBudgetBytes() const {
+        return budgetBytes;
+    }
+    quint64 getEvictedCount() const {
+        return evictedCount;
+    }
+    // totals since the start, the difference before and after drawing is the cost of a frame
+    quint64 getDrawCallCount() const {
+        return drawCallCount;
+    }
+    quint64 getSubmittedIndexCount() const {
+        return submittedIndexCount;
+    }
+
+private:
+    static const int PAGE_VERTEX_CAPACITY = 1 << 18;
+    static const int PAGE_INDEX_CAPACITY = 1 << 20;
+    // entries a compact page can hold. The slot is stored next to the quantized position, its top bit is taken
+    // by the flag for vertices without normal
+    static const int PAGE_DECODE_SLOT_CAPACITY = 1 << 14;
+    static const int DEFAULT_BUDGET_MB = 1024;
+    static const qint64 EVICTION_MIN_AGE_MS = 1000;
+
+    struct Page {
+        VertexFormat vertexFormat = FloatVertices;
+        GLuint vertexBuffer = 0;
+        GLuint indexBuffer = 0;
+        // compact pages only: offset and scale of each slot as two RGBA32F texels
+        GLuint decodeBuffer = 0;
+        GLuint decodeTexture = 0;
+        QVector<int> freeDecodeSlots;
+        int vertexCapacity = 0;
+        int indexCapacity = 0;
+        // offset (key) and size (value) of unused ranges
+        QMap<int, int> freeVertexRanges;
+        QMap<int, int> freeIndexRanges;
+    };
+
+    typedef void (QOPENGLF_APIENTRYP MultiDrawElementsProc)(GLenum mode, const GLsizei *count, GLenum type,
+                                                            const void *const *indices, GLsizei drawCount);
+
+    // deleted pages stay in the list with no buffers, so that the page numbers of entries remain valid
+    QVector<Page> pages;
+    QVector<Owner *> owners;
+    QElapsedTimer clock;
+    size_t budgetBytes;
+    size_t usedBytes = 0;
+    size_t peakUsedBytes = 0;
+    size_t peakResidentBytes = 0;
+    quint64 evictedCount = 0;
+    int boundPage = -1;
+    VertexInput boundVertexInput = FixedFunctionArrays;
+    bool vertexInputEnabled = false;
+    // release() emptied a page, which needs a context to be deleted
+    bool emptyPagesPending = false;
+    MultiDrawElementsProc multiDrawElements = nullptr;
+    bool multiDrawElementsResolved = false;
+    quint64 drawCallCount = 0;
+    quint64 submittedIndexCount = 0;
+
+    int createPage(int vertexCapacity, int indexCapacity, VertexFormat vertexFormat);
+    void deleteEmptyPages();
+    static bool isEmpty(const Page &page);
+    void disableVertexInput();
+    static bool allocateRange(QMap<int, int> &freeRanges, int size, int &offset);
+    static void freeRange(QMap<int, int> &freeRanges, int offset, int size);
+};
+
+
+#endif //BRLCAD_GEOMETRYCACHE_H
@@ -0,0 +1,117 @@
+/*                    G E O M E T R Y D A T A . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file GeometryData.h */
+
+#ifndef BRLCAD_GEOMETRYDATA_H
+#define BRLCAD_GEOMETRYDATA_H
+
+#include <cfloat>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <qopengl.h>
+#include "brlcad/VectorList.h"
+
+// axis aligned, in model coordinates
+struct BoundingBox {
+    GLfloat minimum[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    GLfloat maximum[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    bool isEmpty() const;
+    void extend(const GLfloat *point);
+    void extend(const BoundingBox &other);
+};
+
+/*
+ * CPU side copy of a plotted object, packed the way GeometryCache uploads it.
+ * Vertices are interleaved position and normal floats. Vertices with the same position and normal are stored once
+ * and shared by all primitives using them, which is what makes triangle meshes small. Line strips of the vector list are stored as
+ * GL_LINES index pairs and polygons are triangulated as fans, so every object can be drawn with at
+ * most one indexed draw per primitive type.
+ */
+class GeometryData {
+public:
+    enum Primitive {
+        Lines,
+        Triangles,
+        Points,
+        PrimitiveCount
+    };
+
+    static const int FLOATS_PER_VERTEX = 6;
+    // including full detail
+    static const int MAX_LEVELS_OF_DETAIL = 3;
+
+    // x, y, z, nx, ny, nz for each vertex
+    QVector<GLfloat> vertices;
+    QVector<GLuint> indices[PrimitiveCount];
+    // size of the grid cells vertices were merged in. 0 for full detail
+    GLfloat clusterCellSize = 0;
+
+    void appendVectorList(BRLCAD::VectorList &vectorList);
+    void clear();
+
+    bool isEmpty() const;
+    int vertexCount() const;
+    int indexCount() const;
+    size_t byteSize() const;
+    BoundingBox boundingBox() const;
+
+    // coarser copy, all vertices of a primitive type inside the same grid cell are merged into one
+    GeometryData simplified(GLfloat cellSize) const;
+    // this object first, followed by simplified copies with decreasing detail
+    QVector<GeometryData> levelsOfDetail() const;
+    // everything levelsOfDetail() depends on besides the plotted object, for keying caches of its results
+    static QByteArray levelOfDetailParameters();
+
+private:
+    GLuint addVertex(const double *point, const double *normal);
+
+    // position and normal of a vertex as they are stored
+    struct WeldKey {
+        GLfloat values[FLOATS_PER_VERTEX];
+
+        bool operator==(const WeldKey &other) const;
+    };
+    friend size_t qHash(const WeldKey &key, size_t seed);
+
+    class AppendElementCallback {
+    public:
+        struct AppendVars {
+            // vertices added by this vector list, for welding
+            QHash<WeldKey, GLuint> weldedVertices;
+            double normal[3] = {0., 0., 0.};
+            GLuint lastLineVertex = 0;
+            bool lineStarted = false;
+            QVector<GLuint> polygonVertices;
+            QVector<GLuint> triangleVertices;
+        };
+        GeometryData *geometryData;
+        AppendVars *vars;
+        explicit AppendElementCallback(GeometryData *geometryData, AppendVars *vars);
+        bool operator()(BRLCAD::VectorList::Element *element);
+
+    private:
+        GLuint weldedVertex(const double *point, const double *normal);
+    };
+};
+
+
+#endif //BRLCAD_GEOMETRYDATA_H
@@ -22,32 +22,180 @@
 #ifndef BRLCAD_GEOMETRYRENDERER_H
 #define BRLCAD_GEOMETRYRENDERER_H
 
+#include <deque>
+#include <QElapsedTimer>
+#include <QMatrix4x4>
+#include <QSet>
 #include "ViewportManager.h"
+#include "GeometryCache.h"
+#include "TessellationPool.h"
+#include "RenderQueue.h"
 #include "Renderer.h"
+#include "OcclusionCuller.h"
 
-class GeometryRenderer:public Renderer {
+class Viewport;
+
+/*
+ * Every drawable object is plotted once by name, in its own coordinate system. All places it is used at in the
+ * object tree share that geometry in the cache, and each occurrence is drawn with its own placement matrix, the
+ * leaf matrices of the combinations above it. On the shader pipeline all occurrences of an object in one color
+ * are a single instanced draw, see RenderQueue.
+ * Geometry that was not drawn for a while may be evicted by the geometry cache; it is uploaded again, through the
+ * tessellation pool and its cache, as soon as it comes back into view.
+ */
+class GeometryRenderer:public Renderer, public GeometryCache::Owner {
 public:
 
     explicit GeometryRenderer(Document* document);
+    virtual ~GeometryRenderer();
 
     // this is called by Viewport to render a single frame
+    void render(Viewport *viewport);
     void render() override;
     void refreshForVisibilityAndSolidChanges();
     void clearSolidIfAvailable(int objectId);
     void clearObject(int objectId);
 
+    TessellationPool *getTessellationPool() const {
+        return tessellationPool;
+    }
+
+    // uploads the geometry of this document as GeometryCache::CompactVertices if the viewports have a shader
+    // pipeline. Changing it uploads everything again
+    bool getCompactVertices() const {
+        return compactVertices;
+    }
+    void setCompactVertices(bool compactVertices);
+
+    // progress of plotting and uploading the objects made visible by the last refresh
+    int getStreamedObjectCount() const;
+    int getStreamTotal() const {
+        return streamTotal;
+    }
+
+    // frustum culling results of the last rendered viewport
+    int getDrawnObjectCount() const {
+        return drawnObjectCount;
+    }
+    int getCulledObjectCount() const {
+        return culledObjectCount;
+    }
+    // objects skipped because the occlusion culler found them hidden, see OcclusionCuller
+    int getOccludedObjectCount() const {
+        return occludedObjectCount;
+    }
+    // draw call groups of the last rendered viewport
+    int getDrawnGroupCount() const {
+        return renderQueue.getGroupCount();
+    }
+
+    void collectEvictionCandidates(QVector<GeometryCache::EvictionCandidate> &candidates) override;
+    void evict(const GeometryCache::EvictionCandidate &candidate) override;
+
 private:
+    // time per frame spent on plotting and uploading, so that the viewports stay responsive while a model loads
+    static const int FRAME_BUDGET_MS = 8;
+    // how many pixels a merged grid cell of a simplified level may cover before a finer level is drawn
+    static constexpr float LEVEL_OF_DETAIL_PIXEL_ERROR = 1.5f;
+    // objects whose bounding box diagonal is shorter on screen are left out while the viewport reduces detail
+    static constexpr float REDUCED_DETAIL_MIN_OBJECT_PIXELS = 4.f;
+
     Document* document;
     float defaultWireColor[3] = {1.0,.1,.4};
+    // shared by all documents, see Globals::geometryCache
+    GeometryCache &geometryCache;
+    // plots objects of the document's file in the background. nullptr for documents without a file
+    TessellationPool *tessellationPool = nullptr;
+    // objects with a larger id were created after opening the file and are unknown to the pool's workers
+    int lastFileObjectId;
+    bool compactVertices;
+    // decided by the active viewport at the start of each of its frames
+    GeometryCache::VertexFormat uploadVertexFormat = GeometryCache::FloatVertices;
+
+
+    void drawSolid(const QString &objectName);
+    void uploadGeometry(const QString &objectName, const QVector<GeometryData> &levelsOfDetail);
+    void streamObjects();
+    void repaintAffectedViewports(Viewport *streamingViewport);
+    // repaints the viewport once the current frame is done
+    void continueInNextFrame(Viewport *viewport);
+    bool isUploaded(const QString &objectName) const;
+    bool collectTessellatedObjects(const QElapsedTimer &frameTimer);
+    bool refineObjects(const QElapsedTimer &frameTimer);
+    bool plotOnGuiThread(int objectId) const;
+    void makeVisible(int objectId);
+    QMatrix4x4 placementMatrix(int objectId);
+    void buildBoundingVolumeHierarchy();
+    // objects of a subtree that the occlusion culler found hidden, drawn under conditional rendering
+    struct ConditionalNode {
+        int nodeId;
+        QVector<int> objectIds;
+    };
+    void cullObjects(const QMatrix4x4 &viewProjection, OcclusionCuller *occlusionCuller, QVector<int> &drawnObjectIds,
+                     QVector<int> &openedNodeIds, QVector<int> &occludedNodeIds,
+                     QVector<ConditionalNode> &conditionalNodes);
+    void collectObjectsInFrustum(int rootId, const QMatrix4x4 &viewProjection, OcclusionCuller *occlusionCuller,
+                                 QVector<int> &drawnObjectIds, QVector<int> &openedNodeIds,
+                                 QVector<int> &occludedNodeIds, QVector<ConditionalNode> &conditionalNodes);
+    void drawVisibleObjects(Viewport *viewport);
+    bool queueObject(RenderQueue &queue, int objectId, float pixelsPerUnit, bool reducedDetail, qint64 now);
+    void objectColor(int objectId, float color[3]);
 
+    // levels of detail of an object, see GeometryData::levelsOfDetail()
+    struct ObjectGeometry {
+        // the coarsest level is uploaded first, finer levels stay invalid until refineObjects() uploads them
+        QVector<GeometryCache::Entry> levels;
+        QVector<GLfloat> clusterCellSizes;
+        // in the object's own coordinate system
+        BoundingBox boundingBox;
+        // see GeometryCache::timestamp(), set when uploaded and when drawn
+        qint64 lastDrawn = 0;
+        // the levels were released by evict(), the rest is kept for culling
+        bool evicted = false;
+    };
+    static const GeometryCache::Entry &levelOfDetail(const ObjectGeometry &objectGeometry, float pixelsPerUnit);
 
-    void drawSolid(int objectId);
+    // Contains uploaded vertex and index ranges of drawable objects. Object name is the key.
+    QHash<QString, ObjectGeometry> objectNameGeometryMap;
+    // finer levels of detail that are not uploaded yet, coarsest last
+    QHash<QString, QVector<GeometryData>> pendingLevelsOfDetail;
+    std::deque<QString> refinementQueue;
+    // accumulated leaf matrices from the top object down to objectId. objectId is the key.
+    QHash<int, QMatrix4x4> objectIdPlacementMatrixMap;
 
-    // Contains generated display list alone with corresponding objectId. objectId is the key. displayListId is value.
-    QHash<int, int>             objectIdViewportListIdMap;
+    struct BoundingVolume {
+        BoundingBox box;
+        // visible objects in the subtree
+        int objectCount = 0;
+    };
+    // keys are the visible objects and all their ancestors
+    QHash<int, BoundingVolume> boundingVolumeHierarchy;
+    bool boundingVolumeHierarchyOutdated = true;
+    int drawnObjectCount = 0;
+    int culledObjectCount = 0;
+    int occludedObjectCount = 0;
+    // changes whenever the drawn geometry changes, so the occlusion cullers of the viewports query again
+    int sceneVersion = 0;
+    RenderQueue renderQueue;
+    RenderQueue conditionalRenderQueue;
 
-    QVector<int> visibleViewportListIds;
+    QVector<int> visibleObjectIds;
     QVector<int> objectsToBeViewportedIds;
+    // objectsToBeViewportedIds before this index are handled
+    int nextObjectToBeViewported = 0;
+    int streamTotal = 0;
+    int reportedStreamedObjectCount = -1;
+    // visible objects whose geometry is still being plotted by the tessellation pool
+    QVector<int> waitingObjectIds;
+    QSet<QString> pendingObjectNames;
+    // evicted objects that were in view, uploaded again by streamObjects()
+    QSet<int> evictedObjectIdsInView;
+    // plotted by the tessellation pool but not uploaded yet
+    std::deque<TessellationPool::Result> tessellatedResults;
+    // objects changed since the file was opened
+    QSet<QString> staleObjectNames;
+    // objects whose drawn geometry changed while streaming, see repaintAffectedViewports()
+    QSet<QString> changedObjectNames;
 };
 
 
@@ -5,11 +5,17 @@
 
 class MainWindow;
 class QSSPreprocessor;
+class GeometryCache;
+class RepaintScheduler;
 
 class Globals{
 public:
     static QSSPreprocessor *theme;
     static MainWindow *mainWindow;
+    // GPU geometry of all documents. Lives in the application wide OpenGL share group.
+    static GeometryCache *geometryCache;
+    // all viewport repaints go through it, see Viewport::forceRerenderFrame
+    static RepaintScheduler *repaintScheduler;
 };
 
 
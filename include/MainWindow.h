@@ -11,6 +11,7 @@
 #include <QStatusBar>
 #include <QMenuBar>
 #include <QComboBox>
+#include <QProgressBar>
 #include "MouseAction.h"
 
 class Document;
@@ -30,6 +31,9 @@ public:
 
     const int statusBarShortMessageDuration = 7000;
 
+    // shows how many of the visible objects of a document are drawn. Ignored if the document is not the active one.
+    void updateLoadingProgress(int documentId, int loadedObjectCount, int totalObjectCount);
+
 private:
 	// UI components
     Dockable *objectTreeWidgetDockable;
@@ -40,6 +44,7 @@ private:
     QTabWidget *documentArea;
     QPushButton * maximizeButton;
     QLabel *statusBarPathLabel;
+    QProgressBar *loadingProgressBar;
     QComboBox * currentViewport;
     QAction* singleViewAct[4];
     MouseAction *m_mouseAction;
@@ -0,0 +1,118 @@
+/*                 O C C L U S I O N C U L L E R . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file OcclusionCuller.h */
+
+#ifndef BRLCAD_OCCLUSIONCULLER_H
+#define BRLCAD_OCCLUSIONCULLER_H
+
+#include <QHash>
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QVector>
+#include "GeometryData.h"
+
+/*
+ * Finds bounding volume hierarchy nodes that are hidden behind other geometry, with occlusion queries on their
+ * boxes against the depth buffer of the finished frame. The results are read in the next frame, so nothing waits
+ * for the GPU; a node that was found occluded is skipped until a later query finds it visible again.
+ * Internal nodes are queried along with the leaves, so a hidden subtree costs one query instead of one per object.
+ * The result of a node that was not looked at in the previous frame, e.g. below a node that was occluded then, is
+ * outdated and ignored, so revealed subtrees are drawn and queried again from the top.
+ * Nodes whose latest query is still running can be drawn under conditional rendering, which lets the GPU drop
+ * them by itself once the query finishes.
+ *
+ * Queries are issued only after the camera or the scene changed, or after a node changed between occluded and
+ * visible, so a still scene settles and stops asking for frames.
+ * Query objects are not shared between contexts, so there is one culler per viewport. It has to be created, used
+ * and deleted with the viewport's context current.
+ */
+class OcclusionCuller : protected QOpenGLExtraFunctions {
+public:
+    OcclusionCuller();
+    virtual ~OcclusionCuller();
+
+    bool isValid() const {
+        return valid;
+    }
+    bool hasConditionalRender() const {
+        return beginConditionalRenderProc != nullptr;
+    }
+
+    // reads the finished queries. sceneVersion changes whenever objects or their geometry change
+    void beginFrame(const QMatrix4x4 &viewProjection, int sceneVersion);
+    // false if the results of the last queries still match the frame, then issueQueries() does nothing
+    bool needsQueries() const {
+        return queriesNeeded;
+    }
+    // to be called once per frame for every node the traversal reaches, as that keeps its result current
+    bool isOccluded(int nodeId);
+    // false for boxes that contain the eye or reach in front of the near plane. Their front faces are clipped, so a
+    // query would only test their back faces against the depth of what is inside and find them hidden
+    bool canBeOccluded(const BoundingBox &box) const;
+    bool hasPendingQuery(int nodeId) const;
+    // draws in between are discarded if the node's pending query finds it occluded
+    void beginConditionalRender(int nodeId);
+    void endConditionalRender();
+    // boxes are in world coordinates, the camera matrices have to be loaded into the fixed function pipeline
+    void issueQueries(const QVector<int> &nodeIds, const QVector<BoundingBox> &boxes);
+    // forgets all results, for frames without surfaces that could occlude anything
+    void clear();
+    // false once the results match what is on screen
+    bool needsNextFrame() const;
+
+private:
+    struct NodeState {
+        GLuint query = 0;
+        bool occluded = false;
+        bool pending = false;
+        // the view its query was issued for
+        quint64 queriedViewNumber = 0;
+        // the last frame isOccluded() was asked for the node
+        quint64 visitedFrameNumber = 0;
+    };
+
+    typedef void (QOPENGLF_APIENTRYP BeginConditionalRenderProc)(GLuint id, GLenum mode);
+    typedef void (QOPENGLF_APIENTRYP EndConditionalRenderProc)();
+
+    bool valid = false;
+    GLenum queryTarget;
+    BeginConditionalRenderProc beginConditionalRenderProc = nullptr;
+    EndConditionalRenderProc endConditionalRenderProc = nullptr;
+
+    QHash<int, NodeState> nodeStates;
+    QVector<int> pendingNodeIds;
+    // what the last queries were issued for and what the current frame shows
+    QMatrix4x4 queriedViewProjection;
+    int queriedSceneVersion = -1;
+    QMatrix4x4 frameViewProjection;
+    int frameSceneVersion = 0;
+    // counts the changes of the view projection or the scene
+    quint64 viewNumber = 0;
+    quint64 frameNumber = 0;
+    // nodes were left out of the last queries while their running query was for an earlier view
+    bool outdatedQueriesSkipped = false;
+    bool queriesNeeded = true;
+    bool nextFrameNeeded = false;
+
+    static void drawBox(const BoundingBox &box);
+};
+
+
+#endif //BRLCAD_OCCLUSIONCULLER_H
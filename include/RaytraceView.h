@@ -33,35 +33,67 @@
 
 #include <QWidget>
 #include <QMatrix4x4>
+#include <QLabel>
+#include <QPushButton>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTimer>
 
-#include <brlcad/Database/ConstDatabase.h>
 #include "Document.h"
+#include "TiledRaytracer.h"
 
 
+/*
+ * Shows the raytraced image of a document's viewport while TiledRaytracer refines it, with buttons to cancel
+ * the tracing and to save the image.
+ */
 class RaytraceView : public QWidget {
     Q_OBJECT
 public:
     RaytraceView(Document * document,
                  QWidget*               parent = 0);
+    virtual ~RaytraceView();
     void raytrace();
+    // shades the image again after the raytrace settings changed, without shooting rays
+    void reshade();
+    // called by the active viewport when its camera moved
+    void viewportCameraChanged();
 public slots:
     void Update();
     void UpdateTrafo(const QMatrix4x4& transformation);
+    void cancel();
+    void saveImage();
 
 protected:
     virtual void paintEvent(QPaintEvent* event);
+    virtual void closeEvent(QCloseEvent* event);
 
 private:
+    static const int PREVIEW_INTERVAL_MS = 100;
+
     Document* document;
-    BRLCAD::ConstDatabase& m_database;
     QMatrix4x4             m_transformation;
-    QImage                 m_image;
-    bool                   m_imageUpTodate;
-    bool                   m_updatingImage;
+    QSize                  m_imageSize;
+    quint64                m_imageNumber = 0;
+
+    TiledRaytracer*        raytracer = nullptr;
+    QTemporaryDir*         temporaryDir = nullptr;
+    QString                m_raytracerDatabasePath;
+    QStringList            m_raytracerSelectedPaths;
+
+    QLabel*                statusLabel;
+    QPushButton*           cancelButton;
+    QPushButton*           saveButton;
+    QTimer                 previewTimer;
 
     void UpdateImage(void);
+    QMatrix4x4 viewportTransformation() const;
+    void passFinished(quint64 imageNumber, int pass);
+    bool createRaytracer();
+    static TiledRaytracer::Shading readShading();
 
-    QColor color;
+    // full paths of the visible objects
+    QStringList selectedPaths;
 };
 
 
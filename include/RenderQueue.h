@@ -0,0 +1,83 @@
+/*                     R E N D E R Q U E U E . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file RenderQueue.h */
+
+#ifndef BRLCAD_RENDERQUEUE_H
+#define BRLCAD_RENDERQUEUE_H
+
+#include <QHash>
+#include <QMatrix4x4>
+#include <QVector>
+#include "GeometryCache.h"
+
+class ViewportManager;
+
+/*
+ * Collects the objects of a frame and draws them grouped by color and buffer page, so that the number of draw calls
+ * follows the number of distinct colors instead of the number of objects. Within a group the objects at their own
+ * coordinates are drawn with one call, and the placed occurrences of each cache entry with one instanced draw.
+ * Groups are sorted by color. Wires and points of all groups are drawn before the surfaces of all groups, so the
+ * lighting material only changes between colors and once between the two passes.
+ */
+class RenderQueue {
+public:
+    void clear();
+    void add(const GeometryCache::Entry *entry, const float color[3], const QMatrix4x4 &matrix);
+    void draw(ViewportManager *viewportManager, GeometryCache &geometryCache);
+
+    int getGroupCount() const {
+        return groups.size();
+    }
+
+private:
+    struct GroupKey {
+        float color[3];
+        int page;
+
+        bool operator==(const GroupKey &other) const {
+            return color[0] == other.color[0] && color[1] == other.color[1] && color[2] == other.color[2] &&
+                   page == other.page;
+        }
+        friend size_t qHash(const GroupKey &key, size_t seed = 0) {
+            return qHashMulti(seed, key.color[0], key.color[1], key.color[2], key.page);
+        }
+    };
+
+    struct PlacedEntry {
+        const GeometryCache::Entry *entry;
+        QVector<QMatrix4x4> placements;
+    };
+
+    struct Group {
+        GroupKey key;
+        // objects at their own coordinates
+        QVector<const GeometryCache::Entry *> entries;
+        QVector<PlacedEntry> placedEntries;
+        QHash<const GeometryCache::Entry *, int> placedEntryIndices;
+    };
+
+    QVector<Group> groups;
+    QHash<GroupKey, int> groupIndices;
+
+    void drawPass(ViewportManager *viewportManager, GeometryCache &geometryCache, bool surfaces);
+};
+
+
+#endif //BRLCAD_RENDERQUEUE_H
@@ -0,0 +1,55 @@
+/*                R E P A I N T S C H E D U L E R . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file RepaintScheduler.h */
+
+#ifndef BRLCAD_REPAINTSCHEDULER_H
+#define BRLCAD_REPAINTSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+class Viewport;
+
+/*
+ * Collects repaint requests of viewports and repaints each of them at most once per display refresh.
+ * Requests for viewports that are hidden or fully covered are dropped, they get painted anyway when they are shown.
+ * All of this happens on the GUI thread, requests from elsewhere have to be queued to it.
+ */
+class RepaintScheduler : public QObject {
+    Q_OBJECT
+public:
+    explicit RepaintScheduler(QObject *parent = nullptr);
+
+    void requestRepaint(Viewport *viewport);
+
+private:
+    QVector<QPointer<Viewport>> pendingViewports;
+    QTimer flushTimer;
+    QElapsedTimer sinceLastFlush;
+
+    int frameIntervalMs() const;
+    void flush();
+};
+
+
+#endif //BRLCAD_REPAINTSCHEDULER_H
@@ -0,0 +1,110 @@
+/*                  S H A D E R P I P E L I N E . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file ShaderPipeline.h */
+
+#ifndef BRLCAD_SHADERPIPELINE_H
+#define BRLCAD_SHADERPIPELINE_H
+
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include "GeometryCache.h"
+
+/*
+ * Draws GeometryCache entries with GLSL shaders instead of the fixed function pipeline.
+ * The camera matrices live in a uniform buffer that is updated once per change instead of per draw, and
+ * wire and lit surface shading are done in the fragment shader, so no per draw material state is set.
+ * The occurrences of an entry at several placements can be drawn with one instanced draw, the placements are
+ * streamed to a per instance matrix attribute.
+ * Only OpenGL 3.3 core features are used.
+ *
+ * Vertex array objects are not shared between contexts, so there is one pipeline per viewport. It has to be
+ * created, used and deleted with the viewport's context current. Check isValid() after creating it; on contexts
+ * older than 3.3 or if the shaders do not compile ViewportManager keeps using the fixed function pipeline.
+ */
+class ShaderPipeline : protected QOpenGLExtraFunctions {
+public:
+    ShaderPipeline();
+    virtual ~ShaderPipeline();
+
+    bool isValid() const {
+        return valid;
+    }
+
+    void setCamera(const QMatrix4x4 &modelView, const QMatrix4x4 &projection);
+    void setPlacementMatrix(const QMatrix4x4 &placementMatrix);
+
+    void drawWires(GeometryCache &geometryCache, const QVector<const GeometryCache::Entry *> &entries,
+                   const float wireColor[4]);
+    void drawSurfaces(GeometryCache &geometryCache, const QVector<const GeometryCache::Entry *> &entries,
+                      const float diffuseColor[4], const float ambientColor[4], const float backDiffuseColor[4]);
+    // the entry once per placement, each relative to the placement matrix
+    void drawWires(GeometryCache &geometryCache, const GeometryCache::Entry &entry,
+                   const QVector<QMatrix4x4> &placements, const float wireColor[4]);
+    void drawSurfaces(GeometryCache &geometryCache, const GeometryCache::Entry &entry,
+                      const QVector<QMatrix4x4> &placements, const float diffuseColor[4],
+                      const float ambientColor[4], const float backDiffuseColor[4]);
+    // gives the context back to the fixed function pipeline
+    void release(GeometryCache &geometryCache);
+
+    // one quad on the z = 0 plane with the lines computed in the fragment shader, blending has to be enabled
+    void drawGrid(float spacing, float halfLength, const float color[4]);
+
+private:
+    static const GLuint CAMERA_BINDING = 0;
+    // a mat4 attribute takes four locations
+    static const GLuint INSTANCE_PLACEMENT_LOCATION = 3;
+
+    bool valid = false;
+    bool bound = false;
+    QOpenGLShaderProgram geometryProgram;
+    QOpenGLShaderProgram gridProgram;
+    QOpenGLVertexArrayObject vertexArrayObject;
+    GLuint cameraBuffer = 0;
+    GLuint instanceBuffer = 0;
+
+    QMatrix4x4 modelView;
+    QMatrix4x4 placementMatrix;
+    bool placementUniformsOutdated = true;
+
+    int litLocation;
+    int colorLocation;
+    int ambientColorLocation;
+    int backDiffuseColorLocation;
+    int placementMatrixLocation;
+    int instancedLocation;
+    int normalMatrixLocation;
+    int compactVerticesLocation;
+    int gridSpacingLocation;
+    int gridHalfLengthLocation;
+    int gridColorLocation;
+
+    bool linkProgram(QOpenGLShaderProgram &program, const QString &vertexShader, const QString &fragmentShader);
+    void bind();
+    void setWireUniforms(const float wireColor[4]);
+    void setSurfaceUniforms(const float diffuseColor[4], const float ambientColor[4], const float backDiffuseColor[4]);
+    void bindPage(GeometryCache &geometryCache, const GeometryCache::Entry &entry);
+    void bindInstances(const QVector<QMatrix4x4> &placements);
+    void releaseInstances();
+};
+
+
+#endif //BRLCAD_SHADERPIPELINE_H
@@ -0,0 +1,87 @@
+/*               T E S S E L L A T I O N C A C H E . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file TessellationCache.h */
+
+#ifndef BRLCAD_TESSELLATIONCACHE_H
+#define BRLCAD_TESSELLATIONCACHE_H
+
+#include <mutex>
+#include <QFile>
+#include <QHash>
+#include "GeometryData.h"
+
+/*
+ * Keeps the levels of detail plotted from a database file on disk, so that reopening the file does not
+ * tessellate unchanged objects again. There is one cache file per database file in the user's cache directory.
+ *
+ * An object's entry is keyed by its name and a hash of its record in the database file together with
+ * GeometryData::levelOfDetailParameters(). The records are read directly from the file (db5 format only), so an
+ * object that was changed and saved misses the cache and gets plotted again.
+ *
+ * The cache file is memory mapped by load(); entries are copied out of it on find(). New entries are kept in memory
+ * until save() rewrites the file. find() and insert() can be called from several threads at once.
+ */
+class TessellationCache {
+public:
+    explicit TessellationCache(const QString &databasePath);
+
+    // reads the database file's records and maps the cache file, has to be called before find() or insert()
+    void load();
+    bool find(const QString &objectName, QVector<GeometryData> &levelsOfDetail) const;
+    void insert(const QString &objectName, const QVector<GeometryData> &levelsOfDetail);
+    // writes the file if something was inserted, no other thread may use the cache anymore
+    void save();
+
+private:
+    // 2: vertices of plotted objects are welded
+    static const quint32 FORMAT_VERSION = 2;
+
+    struct MappedEntry {
+        QByteArray key;
+        qint64 offset;
+        qint64 size;
+    };
+
+    struct InsertedEntry {
+        QByteArray key;
+        QByteArray data;
+    };
+
+    const QString databasePath;
+    QString cachePath;
+    bool enabled = false;
+    // hash of the database record of every object, see readDatabaseKeys()
+    QHash<QString, QByteArray> objectKeys;
+
+    QFile cacheFile;
+    const uchar *mappedData = nullptr;
+    QHash<QString, MappedEntry> mappedEntries;
+
+    mutable std::mutex insertedMutex;
+    QHash<QString, InsertedEntry> insertedEntries;
+
+    bool readDatabaseKeys();
+    bool mapCacheFile();
+    static QByteArray serialize(const QVector<GeometryData> &levelsOfDetail);
+    static bool deserialize(const uchar *data, qint64 size, QVector<GeometryData> &levelsOfDetail);
+};
+
+
+#endif //BRLCAD_TESSELLATIONCACHE_H
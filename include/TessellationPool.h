@@ -0,0 +1,90 @@
+/*                T E S S E L L A T I O N P O O L . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file TessellationPool.h */
+
+#ifndef BRLCAD_TESSELLATIONPOOL_H
+#define BRLCAD_TESSELLATIONPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QObject>
+#include <QStringList>
+#include "GeometryData.h"
+#include "TessellationCache.h"
+
+/*
+ * Plots objects into GeometryData on worker threads, including the simplified levels of detail.
+ * librt is not safe to use concurrently on one database, so every worker opens its own read only copy of the
+ * database file and the document's MemoryDatabase is never touched off the GUI thread. Because of that the
+ * workers only know the objects as they are on disk; objects created or edited after opening the file have to
+ * be plotted by the caller.
+ *
+ * Objects found in the TessellationCache are not plotted at all; a worker only loads the database once it misses.
+ * The cache is saved in the global QThreadPool once the workers stopped, so closing a document does not wait for
+ * the file to be written. QCoreApplication waits for it on exit.
+ *
+ * Results are collected until takeResults() is called from the GUI thread. resultsReady() is emitted when the
+ * first result arrives after the last takeResults().
+ */
+class TessellationPool : public QObject {
+    Q_OBJECT
+public:
+    struct Result {
+        QString objectName;
+        bool plotted;
+        // see GeometryData::levelsOfDetail()
+        QVector<GeometryData> levelsOfDetail;
+    };
+
+    explicit TessellationPool(const QString &databasePath, QObject *parent = nullptr);
+    virtual ~TessellationPool();
+
+    // objects are plotted by name in their own coordinate system
+    void enqueue(const QString &objectName);
+    // removes jobs no worker has started yet and returns their object names
+    QStringList cancelQueued();
+    std::vector<Result> takeResults();
+
+signals:
+    void resultsReady();
+
+private:
+    static const int MAX_DEFAULT_WORKERS = 4;
+
+    const QByteArray databasePath;
+    // shared with the save that outlives the pool
+    std::shared_ptr<TessellationCache> cache;
+    std::once_flag cacheLoaded;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<QString> jobs;
+    std::vector<Result> results;
+    bool stopping = false;
+
+    void work();
+};
+
+
+#endif //BRLCAD_TESSELLATIONPOOL_H
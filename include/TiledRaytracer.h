@@ -0,0 +1,223 @@
+/*                  T I L E D R A Y T R A C E R . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file TiledRaytracer.h */
+
+#ifndef BRLCAD_TILEDRAYTRACER_H
+#define BRLCAD_TILEDRAYTRACER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QColor>
+#include <QHash>
+#include <QImage>
+#include <QMatrix4x4>
+#include <QObject>
+#include <QStringList>
+#include <brlcad/Database/ConstDatabase.h>
+
+/*
+ * Raytraces an image in square tiles on several threads, progressively: the first pass shoots one ray per 16x16
+ * block and fills the block with its color, the following passes refine that down to one ray per pixel.
+ * Rays already shot in a coarser pass are not shot again.
+ *
+ * Like TessellationPool, every worker loads its own read only copy of the database file, as librt can not shoot
+ * rays concurrently into one database; then it selects the given full paths in it. The workers stay until the
+ * raytracer is deleted, so only the first image waits for the database to load.
+ *
+ * The tiles of a pass are dealt out to the workers' queues in turns. A worker takes tiles from the front of its
+ * own queue and, once that is empty, steals from the back of the others, so a worker that got the expensive part
+ * of the model does not keep the rest waiting. Pixels are written straight into the scanlines of the image; tiles
+ * never overlap, so no locking is needed for that.
+ *
+ * A last pass antialiases edges: pixels whose neighbors hit another region, or a surface at a clearly different
+ * depth or angle, get four more rays in a rotated grid and show the average of them. Elsewhere one ray per pixel
+ * is as good as more, so this costs a small part of supersampling the whole image.
+ *
+ * What a ray hit is kept per pixel in a G-buffer: the region, the distance, the surface normal and the region's
+ * color. reshade() computes the image again from it, so changing the background or the lighting shoots no rays.
+ *
+ * start(), cancel() and reshade() are called from the GUI thread. passFinished() is emitted from a worker thread.
+ */
+class TiledRaytracer : public QObject {
+    Q_OBJECT
+public:
+    static const int TRACING_PASS_COUNT = 3;
+    // follows the tracing passes, unless antialiasing is turned off
+    static const int ANTIALIASING_PASS = TRACING_PASS_COUNT;
+
+    enum ShadingModel {
+        PhongShading,
+        DiffuseShading,
+        // the surface normal as color, for checking the geometry
+        NormalShading
+    };
+
+    struct Shading {
+        ShadingModel model = PhongShading;
+        float ambient = 0.1f;
+        float diffuseWeight = 0.5f;
+        float specularWeight = 0.5f;
+        int shininess = 4;
+        QRgb background = qRgb(0, 0, 0);
+    };
+
+    TiledRaytracer(const QString &databasePath, const QStringList &selectedPaths, QObject *parent = nullptr);
+    virtual ~TiledRaytracer();
+
+    // cancels the image in flight and starts a new one, returns its number for passFinished()
+    quint64 start(const QSize &size, const QMatrix4x4 &transformation, const Shading &shading);
+    // returns once no worker writes into the image anymore
+    void cancel();
+    // shades what is traced so far from the G-buffer, tiles traced later use the new shading too
+    void reshade(const Shading &shading);
+    // written by the workers while tracing, so it may show a tile partly refined
+    const QImage &getImage() const {
+        return image;
+    }
+
+    int getPassCount() const {
+        return passCount;
+    }
+    // the name of a region in the G-buffer
+    QString getRegionName(int regionId) const;
+
+signals:
+    // the image is finished when pass is getPassCount() - 1
+    void passFinished(quint64 imageNumber, int pass);
+    // emitted once no worker could load the database
+    void loadFailed();
+
+private:
+    static const int TILE_SIZE = 32;
+    static const int SUBSAMPLE_COUNT = 4;
+
+    struct Tile {
+        int x;
+        int y;
+        int width;
+        int height;
+        int pass;
+        quint64 imageNumber;
+        // in tiles
+        int index;
+    };
+
+    struct Sample {
+        int regionId;
+        float depth;
+        QVector3D normal;
+        QVector3D baseColor;
+    };
+
+    // indexed by row * width + column, in separate arrays so that shadeSpan() can load several pixels at once
+    struct GBuffer {
+        // -1 where the ray missed
+        std::vector<int> regionIds;
+        std::vector<float> depths;
+        std::vector<float> normalX;
+        std::vector<float> normalY;
+        std::vector<float> normalZ;
+        std::vector<float> red;
+        std::vector<float> green;
+        std::vector<float> blue;
+
+        void append(const Sample &sample);
+    };
+
+    // the antialiased pixels of a tile
+    struct Subsamples {
+        std::vector<size_t> pixelIndices;
+        // SUBSAMPLE_COUNT for every pixel
+        GBuffer samples;
+    };
+
+    struct Frame {
+        uchar *bits;
+        qsizetype bytesPerLine;
+        int width;
+        int height;
+        QMatrix4x4 transformation;
+        QVector3D direction;
+        // in model units
+        float pixelSize;
+        Shading shading;
+    };
+
+    const QByteArray databasePath;
+    const QStringList selectedPaths;
+    int passCount;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    // signaled when tiles are queued or the raytracer is deleted
+    std::condition_variable tilesQueued;
+    // signaled when a worker stops tracing a tile
+    std::condition_variable tileStopped;
+    std::vector<std::deque<Tile>> queues;
+    int queuedTileCount = 0;
+    int runningTileCount = 0;
+    // tiles of the current pass that are not traced yet
+    int remainingTileCount = 0;
+    int failedWorkerCount = 0;
+    // no tiles are taken while reshading
+    bool paused = false;
+    bool stopping = false;
+    std::vector<Tile> tiles;
+    QImage image;
+    GBuffer gBuffer;
+    // by tile index, each written only by the worker antialiasing the tile
+    std::vector<Subsamples> tileSubsamples;
+    Frame currentFrame;
+    // read without the mutex by the workers to abandon tiles of canceled images
+    std::atomic<quint64> imageNumber{0};
+
+    mutable std::mutex regionMutex;
+    QStringList regionNames;
+    QHash<QString, int> regionIds;
+
+    void work(int workerIndex);
+    // these need the mutex to be held
+    void queuePass(int pass);
+    void clearQueues();
+    bool takeTile(int workerIndex, Tile &tile);
+
+    void traceTile(BRLCAD::ConstDatabase &database, QHash<QString, int> &knownRegionIds, const Frame &frame,
+                   const Tile &tile);
+    void antialiasTile(BRLCAD::ConstDatabase &database, QHash<QString, int> &knownRegionIds, const Frame &frame,
+                       const Tile &tile);
+    bool isEdge(const Frame &frame, int column, int row) const;
+    // x and y in pixels, the ray of a pixel is shot at its integer coordinates
+    Sample trace(BRLCAD::ConstDatabase &database, QHash<QString, int> &knownRegionIds, const Frame &frame, float x,
+                 float y);
+    // thread safe, knownRegionIds caches the ids a worker has already looked up
+    int regionId(const QString &regionName, QHash<QString, int> &knownRegionIds);
+    // shades count pixels of the G-buffer from first on into colors, with SSE2 where available
+    static void shadeSpan(const Shading &shading, const QVector3D &direction, const GBuffer &gBuffer, size_t first,
+                          int count, QRgb *colors);
+    // writes the averages of the subsamples into the image
+    static void shadeSubsamples(const Frame &frame, const Subsamples &subsamples);
+};
+
+
+#endif //BRLCAD_TILEDRAYTRACER_H
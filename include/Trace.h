@@ -0,0 +1,75 @@
+/*                         T R A C E . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file Trace.h */
+
+#ifndef BRLCAD_TRACE_H
+#define BRLCAD_TRACE_H
+
+#include <atomic>
+#include <QString>
+
+/*
+ * Records how long scopes take, on any thread, for viewing in chrome://tracing or Perfetto.
+ *
+ *     void GeometryRenderer::render(Viewport *viewport) {
+ *         TRACE_SCOPE("GeometryRenderer::render");
+ *         ...
+ *
+ * Every thread writes into its own ring buffer without locking, only the latest RING_BUFFER_EVENTS scopes of each
+ * thread are kept. Names have to be string literals or otherwise live until the trace is exported.
+ * Tracing is off until setEnabled(true); then a scope costs two clock reads. The application turns it on when the
+ * ARBALEST_TRACE environment variable names a file, and writes the trace to it on exit.
+ */
+class Trace {
+public:
+    static const int RING_BUFFER_EVENTS = 1 << 14;
+
+    class Scope {
+    public:
+        explicit Scope(const char *name);
+        ~Scope();
+
+    private:
+        const char *name;
+        qint64 startNs;
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+    // shown instead of the thread's number in the exported trace
+    static void setThreadName(const QString &name);
+    // Chrome trace event format, can be called while other threads keep tracing
+    static bool exportChromeJson(const QString &filePath);
+
+private:
+    static std::atomic<bool> enabled;
+
+    static qint64 nowNs();
+    static void record(const char *name, qint64 startNs, qint64 endNs);
+};
+
+#define TRACE_CONCATENATE_(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCATENATE(traceScope, __LINE__)(name)
+
+
+#endif //BRLCAD_TRACE_H
@@ -8,10 +8,7 @@
 #include <QtWidgets/QLabel>
 #include "QVBoxWidget.h"
 #include "QHBoxWidget.h"
-#include <chrono>
-#include <stack>
 #include <iostream>
-using namespace std::chrono;
 using namespace std;
 
 BRLCAD::Vector3D operator+(const BRLCAD::Vector3D& a, const BRLCAD::Vector3D& b);
@@ -80,21 +77,6 @@ inline QWidget * toolbarSeparator(bool horizontal){
 
 QImage coloredIcon(QString path, QString colorKey = "");
 
-static std::stack <time_point<high_resolution_clock>> times;
-static std::stack <QString> timerNames;
-inline void ts(QString name = "Timer"){
-    times.push(high_resolution_clock::now());
-    timerNames.push(name);
-}
-
-inline void te(){
-    time_point<high_resolution_clock> startTime = times.top();
-
-    milliseconds duration = duration_cast<milliseconds>( high_resolution_clock::now()-startTime);
-    cout << timerNames.top().toStdString()<< "  "<<duration_cast<milliseconds>( high_resolution_clock::now()-startTime).count() <<" ms        "
-    <<duration_cast<microseconds>( high_resolution_clock::now()-startTime).count()<<" us"<< endl;
-}
-
 class Document;
 bool getObjectNameFromUser(QWidget* parent, Document& document, QString& name);
 
@@ -26,6 +26,7 @@
 #include <include/Globals.h>
 
 #include <QOpenGLWidget>
+#include <QTimer>
 #include "AxesRenderer.h"
 #include <QMouseEvent>
 #include <include/GridRenderer.h>
@@ -34,6 +35,7 @@
 #include "OrthographicCamera.h"
 #include "Globals.h"
 #include "QSSPreprocessor.h"
+#include "FrameStatistics.h"
 
 class Document;
 class ViewportManager;
@@ -49,6 +51,20 @@ public:
     virtual ~Viewport();
 
     void forceRerenderFrame();
+    // draws a frame of the given size into the framebuffer bound in the current context, without using the
+    // widget's own context. For rendering viewports that are never shown, see arbalest_bench
+    void renderFrame(int w, int h);
+
+    // called for every change of the camera made by the user, the interaction ends when no change follows for
+    // INTERACTION_IDLE_MS or with endInteraction()
+    void interact();
+    void endInteraction();
+    // while the user moves the camera and the last full detail frame took longer than INTERACTIVE_FRAME_MS on the
+    // CPU or the GPU,
+    // only the coarsest levels of detail of the objects are drawn and objects of a few pixels are left out
+    bool isReducedDetail() const {
+        return reducedDetail;
+    }
 
     int getW() const;
     int getH() const;
@@ -57,6 +73,8 @@ public:
     ViewportManager* getViewportManager() const;
 
     bool gridEnabled = false;
+    // overlay of frame times and geometry counts, see FrameStatistics
+    bool statisticsEnabled = false;
     bool moveCameraEnabled = false;
 
 protected:
@@ -66,6 +84,9 @@ protected:
     void keyPressEvent(QKeyEvent *k) override ;
 
 private:
+    static const int INTERACTIVE_FRAME_MS = 16;
+    static const int INTERACTION_IDLE_MS = 200;
+
     Document * document;
     int w = 400;
     int h = 400;
@@ -76,6 +97,14 @@ private:
     ViewportManager *displayManager;
     AxesRenderer * axesRenderer;
     GridRenderer * gridRenderer;
+    FrameStatistics *frameStatistics = nullptr;
+
+    bool reduceDetailWhileMoving;
+    bool interacting = false;
+    bool reducedDetail = false;
+    QTimer interactionIdleTimer;
+    // camera of the last frame, to notice its changes whatever made them
+    QMatrix4x4 paintedViewProjection;
 };
 
 
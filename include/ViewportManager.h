@@ -26,16 +26,37 @@
 #include <Windows.h>
 #endif
 
+#include <QMatrix4x4>
 #include "Viewport.h"
+#include "GeometryCache.h"
+#include "ShaderPipeline.h"
+#include "OcclusionCuller.h"
 #include "brlcad/VectorList.h"
 class Viewport;
 
 class ViewportManager{
 public:
     explicit ViewportManager(Viewport &display);
+    // needs the viewport's context to be current
+    virtual ~ViewportManager();
 
     // most of the methods below correspond to a method with a similar name from libdm
     void drawVList(BRLCAD::VectorList *vp);
+    void drawWireGeometry(GeometryCache &geometryCache, const QVector<const GeometryCache::Entry *> &entries);
+    void drawSurfaceGeometry(GeometryCache &geometryCache, const QVector<const GeometryCache::Entry *> &entries);
+    // draws the entry at each placement, with a single instanced draw on the shader pipeline
+    void drawWireGeometry(GeometryCache &geometryCache, const GeometryCache::Entry *entry,
+                          const QVector<QMatrix4x4> &placements);
+    void drawSurfaceGeometry(GeometryCache &geometryCache, const GeometryCache::Entry *entry,
+                             const QVector<QMatrix4x4> &placements);
+    // call after the last draw*Geometry of a frame, before drawing anything else
+    void finishGeometry(GeometryCache &geometryCache);
+    // GeometryCache::CompactVertices can only be drawn with the shader pipeline
+    bool hasShaderPipeline();
+    // nullptr if it is disabled in the settings or the context does not support it
+    OcclusionCuller *getOcclusionCuller();
+    // returns false if there is no shader pipeline, then the caller has to draw the grid lines itself
+    bool drawGrid(float spacing, float halfLength, const float color[4]);
     void setFGColor(float r, float g, float b, float transparency);
     void setBGColor(float r, float g, float b);
     void setLineAttr(int width, int style);
@@ -52,6 +73,9 @@ public:
     void drawBegin();
     void loadMatrix(const GLfloat *m);
     void loadPMatrix(const GLfloat *m);
+    // multiplies the modelview matrix, e.g. to place an occurrence of an object. Has to be undone with popMatrix()
+    void pushMatrix(const GLfloat *m);
+    void popMatrix();
     void setSuffix(const BRLCAD::VectorList& vectorList);
     void clearSuffix(void);
     void drawSuffix(void);
@@ -72,6 +96,11 @@ public:
 private:
     Viewport &display;
 
+    void setWireMaterial() const;
+    void setSurfaceMaterial() const;
+    const float *backDiffuseColor() const;
+    ShaderPipeline *getShaderPipeline();
+
     int dmLight = 1;
     bool dmTransparency = false;
 
@@ -84,6 +113,20 @@ private:
     float bgColor[3] = {0.0, 0.0, 0.125};
 
     BRLCAD::VectorList suffix;
+
+    // the draw*Geometry methods use shaders unless the context is too old or it is disabled in the settings.
+    // The fixed function pipeline is kept as fallback and for everything else.
+    ShaderPipeline *shaderPipeline = nullptr;
+    bool shaderPipelineInitialized = false;
+    QMatrix4x4 modelViewMatrix;
+    QMatrix4x4 projectionMatrix;
+    // what the shader pipeline's camera buffer holds
+    QMatrix4x4 uploadedModelViewMatrix;
+    QMatrix4x4 uploadedProjectionMatrix;
+    bool cameraUploaded = false;
+    QVector<QMatrix4x4> placementMatrixStack;
+    OcclusionCuller *occlusionCuller = nullptr;
+    bool occlusionCullerInitialized = false;
 };
 
 
@@ -0,0 +1,27 @@
+#version 330 core
+
+// 0 for lines and points, which are drawn in the flat wire color
+uniform int lit;
+// wire color, or diffuse color of front faces
+uniform vec4 color;
+uniform vec4 ambientColor;
+uniform vec4 backDiffuseColor;
+
+in vec3 viewNormal;
+
+out vec4 fragmentColor;
+
+// global ambient light of the fixed function pipeline
+const float AMBIENT_LIGHT = 0.2;
+
+void main() {
+    if (lit == 0 || dot(viewNormal, viewNormal) == 0.0) {
+        fragmentColor = color;
+        return;
+    }
+
+    // head light: the light looks along the viewing direction
+    float diffuseLight = abs(normalize(viewNormal).z);
+    vec3 diffuse = gl_FrontFacing ? color.rgb : backDiffuseColor.rgb;
+    fragmentColor = vec4(ambientColor.rgb * AMBIENT_LIGHT + diffuse * diffuseLight, color.a);
+}
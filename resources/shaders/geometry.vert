@@ -0,0 +1,60 @@
+#version 330 core
+
+// shared by all programs of a viewport, see ShaderPipeline
+layout(std140) uniform Camera {
+    mat4 modelView;
+    mat4 projection;
+};
+
+// placement of the object, see GeometryRenderer::placementMatrix
+uniform mat4 placementMatrix;
+// inverse transpose of modelView * placementMatrix
+uniform mat3 normalMatrix;
+// 1 for instanced draws, which take the placement of each occurrence from instancePlacement
+uniform int instanced;
+
+// 1 if the bound page holds GeometryCache::CompactVertices
+uniform int compactVertices;
+// minimum and quantization step of the bounding box of each entry of a compact page, bound to texture unit 0
+uniform samplerBuffer decodeTable;
+
+// compact vertices: quantized position and octahedral encoded normal in x and y
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+// compact vertices only: row in the decode table, the top bit is set for vertices without normal
+layout(location = 2) in uint decodeSlot;
+// instanced draws only: placement of the occurrence relative to placementMatrix, locations 3 to 6
+layout(location = 3) in mat4 instancePlacement;
+
+out vec3 viewNormal;
+
+const uint NO_NORMAL_FLAG = 0x8000u;
+
+vec3 decodeOctahedral(vec2 encoded) {
+    vec3 decoded = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (decoded.z < 0.0) {
+        vec2 signs = vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+        decoded.xy = (1.0 - abs(encoded.yx)) * signs;
+    }
+    return normalize(decoded);
+}
+
+void main() {
+    vec3 objectPosition = position;
+    vec3 objectNormal = normal;
+    if (compactVertices != 0) {
+        int slot = int(decodeSlot & ~NO_NORMAL_FLAG);
+        objectPosition = texelFetch(decodeTable, 2 * slot).xyz + position * texelFetch(decodeTable, 2 * slot + 1).xyz;
+        objectNormal = (decodeSlot & NO_NORMAL_FLAG) != 0u ? vec3(0.0) : decodeOctahedral(normal.xy);
+    }
+
+    mat4 placement = placementMatrix;
+    mat3 placementNormalMatrix = normalMatrix;
+    if (instanced != 0) {
+        placement = placementMatrix * instancePlacement;
+        placementNormalMatrix = transpose(inverse(mat3(modelView * placement)));
+    }
+
+    viewNormal = placementNormalMatrix * objectNormal;
+    gl_Position = projection * modelView * placement * vec4(objectPosition, 1.0);
+}
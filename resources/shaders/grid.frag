@@ -0,0 +1,19 @@
+#version 330 core
+
+// distance between two grid lines
+uniform float spacing;
+uniform vec4 color;
+
+in vec2 planePosition;
+
+out vec4 fragmentColor;
+
+void main() {
+    // distance to the nearest line in pixels, lines are one pixel wide at any zoom and angle
+    vec2 gridPosition = planePosition / spacing;
+    vec2 pixelDistance = abs(fract(gridPosition - 0.5) - 0.5) / fwidth(gridPosition);
+    float coverage = 1.0 - min(min(pixelDistance.x, pixelDistance.y), 1.0);
+    if (coverage <= 0.0) discard;
+
+    fragmentColor = vec4(color.rgb, color.a * coverage);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+// shared by all programs of a viewport, see ShaderPipeline
+layout(std140) uniform Camera {
+    mat4 modelView;
+    mat4 projection;
+};
+
+// the grid covers [-halfLength, halfLength] in x and y of the z = 0 plane
+uniform float halfLength;
+
+out vec2 planePosition;
+
+// drawn as a triangle strip without vertex buffer
+const vec2 CORNERS[4] = vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+void main() {
+    planePosition = CORNERS[gl_VertexID] * halfLength;
+    gl_Position = projection * modelView * vec4(planePosition, 0.0, 1.0);
+}
@@ -5,12 +5,14 @@
 #include <Document.h>
 #include<Viewport.h>
 #include <brlcad/Database/Torus.h>
+#include "Trace.h"
 
 
 Document::Document(const int documentId, const QString *filePath) : documentId(documentId) {
     if (filePath != nullptr) this->filePath = new QString(*filePath);
     database =  new BRLCAD::MemoryDatabase();
     if (filePath != nullptr) {
+        TRACE_SCOPE("Document::load");
         if (!database->Load(filePath->toUtf8().data()))
         {
             throw std::runtime_error("Failed to open file");
@@ -23,6 +25,12 @@ Document::Document(const int documentId, const QString *filePath) : documentId(d
     geometryRenderer = new GeometryRenderer(this);
     objectTreeWidget = new ObjectTreeWidget(this);
     displayGrid = new ViewportGrid(this);
+    if (geometryRenderer->getTessellationPool() != nullptr) {
+        // the active viewport takes the results, see GeometryRenderer::repaintAffectedViewports()
+        QObject::connect(geometryRenderer->getTessellationPool(), &TessellationPool::resultsReady, displayGrid, [this]() {
+            getViewport()->forceRerenderFrame();
+        });
+    }
 
     displayGrid->forceRerenderAllViewports();
 
@@ -30,6 +38,7 @@ Document::Document(const int documentId, const QString *filePath) : documentId(d
 }
 
 Document::~Document() {
+    delete geometryRenderer;
     delete database;
 }
 
@@ -46,7 +55,7 @@ void Document::modifyObject(BRLCAD::Object *newObject) {
     }
     );
     geometryRenderer->refreshForVisibilityAndSolidChanges();
-    for (Viewport * display : displayGrid->getViewports())display->forceRerenderFrame();
+    displayGrid->forceRerenderAllViewports();
 }
 
 bool Document::isModified() {
@@ -59,7 +68,13 @@ bool Document::Add(const BRLCAD::Object& object) {
 }
 
 bool Document::Save(const char* fileName) {
+    if (!SaveCopy(fileName)) return false;
     modified = false;
+    setFilePath(QString::fromUtf8(fileName));
+    return true;
+}
+
+bool Document::SaveCopy(const char* fileName) {
     return database->Save(fileName);
 }
 
@@ -3,4 +3,8 @@
 
 QSSPreprocessor *Globals::theme;
 
-MainWindow *Globals::mainWindow;
\ No newline at end of file
+MainWindow *Globals::mainWindow;
+
+GeometryCache *Globals::geometryCache;
+
+RepaintScheduler *Globals::repaintScheduler;
\ No newline at end of file
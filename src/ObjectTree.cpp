@@ -28,6 +28,7 @@
 
 #include <brlcad/Database/Combination.h>
 #include "ObjectTree.h"
+#include "Trace.h"
 #include <QStandardItemModel>
 #include "brlcad/Database/MemoryDatabase.h"
 
@@ -91,6 +92,7 @@ int ObjectTree::addTopObject(QString name) {
 
 
 ObjectTree::ObjectTree(BRLCAD::MemoryDatabase* database) : database(database) {
+    TRACE_SCOPE("ObjectTree::ObjectTree");
 	BRLCAD::ConstDatabase::TopObjectIterator it = database->FirstTopObject();
 
     objectIdChildrenObjectIdsMap[0] = QVector<int>(); // objectId of root is 0
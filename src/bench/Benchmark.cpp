@@ -0,0 +1,318 @@
+/*                     B E N C H M A R K . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file Benchmark.cpp
+ *
+ * arbalest_bench: opens .g files without showing a window and times the stages of getting them on screen.
+ * Frames are rendered into a framebuffer object of an offscreen surface, so a software renderer like
+ * Mesa's llvmpipe works too. Results are written as JSON, one object per model, to compare releases.
+ *
+ *   arbalest_bench [--frames N] [--size WxH] [--output file.json] [file.g ...]
+ *
+ * Without files the models in extra/db are used. Run with QT_QPA_PLATFORM=offscreen on machines without a display.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QSettings>
+#include <QSurfaceFormat>
+#include "Document.h"
+#include "GeometryCache.h"
+#include "Globals.h"
+#include "QSSPreprocessor.h"
+#include "RepaintScheduler.h"
+#include "Trace.h"
+
+// stop waiting for a model to finish streaming after this long
+static const qint64 STREAM_TIMEOUT_MS = 10 * 60 * 1000;
+
+
+static double elapsedMs(const QElapsedTimer &timer) {
+    return timer.nsecsElapsed() / 1e6;
+}
+
+static void loadTheme() {
+    QFile themeFile(":themes/arbalest_light.theme");
+    themeFile.open(QFile::ReadOnly);
+    Globals::theme = new QSSPreprocessor(QString(themeFile.readAll()));
+}
+
+/*
+ * The stages the GUI goes through, measured one at a time on this thread.
+ * Loading, building the tree and plotting are done on a separate copy of the database, so they are not mixed with
+ * the widgets and the tessellation pool a Document starts.
+ */
+static QJsonObject measureStages(const QString &filePath, GeometryCache &uploadCache, QOpenGLFunctions *functions) {
+    TRACE_SCOPE("measureStages");
+    QJsonObject stages;
+    QElapsedTimer timer;
+
+    BRLCAD::MemoryDatabase database;
+    timer.start();
+    if (!database.Load(filePath.toUtf8().data())) return stages;
+    stages["load_ms"] = elapsedMs(timer);
+
+    timer.start();
+    ObjectTree objectTree(&database);
+    stages["tree_ms"] = elapsedMs(timer);
+
+    // the same objects GeometryRenderer draws after opening the file, each plotted once
+    QSet<QString> objectNames;
+    int occurrenceCount = 0;
+    objectTree.traverseSubTree(0, false, [&](int objectId) {
+        if (objectTree.getObjectVisibility()[objectId] == ObjectTree::Invisible) return false;
+        if (!objectTree.getDrawableObjectIds().contains(objectId)) return true;
+        objectNames.insert(objectTree.getNameMap()[objectId]);
+        occurrenceCount++;
+        return true;
+    });
+
+    QVector<QVector<GeometryData>> plottedObjects;
+    qint64 vertexCount = 0;
+    qint64 indexCount = 0;
+    timer.start();
+    for (const QString &objectName : objectNames) {
+        BRLCAD::VectorList vectorList;
+        database.Plot(objectName.toUtf8().constData(), vectorList);
+        GeometryData geometryData;
+        geometryData.appendVectorList(vectorList);
+        plottedObjects.append(geometryData.levelsOfDetail());
+    }
+    stages["plot_ms"] = elapsedMs(timer);
+
+    QVector<GeometryCache::Entry> entries;
+    timer.start();
+    for (const QVector<GeometryData> &levelsOfDetail : plottedObjects) {
+        for (const GeometryData &level : levelsOfDetail) {
+            entries.append(uploadCache.upload(level));
+            vertexCount += level.vertexCount();
+            indexCount += level.indexCount();
+        }
+    }
+    functions->glFinish();
+    stages["upload_ms"] = elapsedMs(timer);
+    stages["upload_bytes"] = static_cast<qint64>(uploadCache.residentBytes());
+    // the next model reuses the pages
+    for (GeometryCache::Entry &entry : entries) uploadCache.release(entry);
+
+    stages["objects"] = objectNames.size();
+    stages["occurrences"] = occurrenceCount;
+    stages["vertices"] = vertexCount;
+    stages["indices"] = indexCount;
+    return stages;
+}
+
+static QJsonObject frameStatistics(QVector<double> frameTimes) {
+    QJsonObject statistics;
+    if (frameTimes.isEmpty()) return statistics;
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    double total = 0;
+    for (double frameTime : frameTimes) total += frameTime;
+    statistics["count"] = frameTimes.size();
+    statistics["total_ms"] = total;
+    statistics["mean_ms"] = total / frameTimes.size();
+    statistics["min_ms"] = frameTimes.first();
+    statistics["median_ms"] = frameTimes[frameTimes.size() / 2];
+    statistics["p95_ms"] = frameTimes[std::min<int>(frameTimes.size() - 1, frameTimes.size() * 95 / 100)];
+    statistics["max_ms"] = frameTimes.last();
+    return statistics;
+}
+
+/*
+ * Opens the file as a Document like MainWindow does and renders its active viewport offscreen: first until every
+ * visible object has been streamed in, then the given number of frames orbiting the model.
+ */
+static QJsonObject measureDocument(const QString &filePath, QOpenGLContext &context, QOffscreenSurface &surface,
+                                   QOpenGLFramebufferObject &framebuffer, int frameCount) {
+    TRACE_SCOPE("measureDocument");
+    QJsonObject result;
+    QElapsedTimer timer;
+
+    timer.start();
+    Document *document = new Document(0, &filePath);
+    result["document_ms"] = elapsedMs(timer);
+
+    Viewport *viewport = document->getViewport();
+    GeometryRenderer *geometryRenderer = document->getGeometryRenderer();
+    QOpenGLFunctions *functions = context.functions();
+    auto renderFrame = [&]() {
+        // hidden widgets handling queued repaints may touch the current context
+        context.makeCurrent(&surface);
+        framebuffer.bind();
+        viewport->renderFrame(framebuffer.width(), framebuffer.height());
+        functions->glFinish();
+    };
+
+    viewport->getCamera()->autoview();
+    int streamFrames = 0;
+    timer.start();
+    do {
+        QCoreApplication::processEvents();
+        renderFrame();
+        streamFrames++;
+    } while (geometryRenderer->getStreamedObjectCount() < geometryRenderer->getStreamTotal() &&
+             timer.elapsed() < STREAM_TIMEOUT_MS);
+    result["stream_ms"] = elapsedMs(timer);
+    result["stream_frames"] = streamFrames;
+    result["stream_complete"] = geometryRenderer->getStreamedObjectCount() >= geometryRenderer->getStreamTotal();
+
+    // the view direction changes, the camera target and zoom do not
+    viewport->getCamera()->autoview();
+    const QVector3D angles = viewport->getCamera()->getAnglesAroundAxes();
+    QVector<double> frameTimes;
+    for (int i = 0; i < frameCount; i++) {
+        viewport->getCamera()->setAnglesAroundAxes(angles.x(), angles.y(), angles.z() + 360.f * i / frameCount);
+        timer.start();
+        renderFrame();
+        frameTimes.append(elapsedMs(timer));
+    }
+    result["frames"] = frameStatistics(frameTimes);
+    result["drawn_objects"] = geometryRenderer->getDrawnObjectCount();
+    result["culled_objects"] = geometryRenderer->getCulledObjectCount();
+    result["occluded_objects"] = geometryRenderer->getOccludedObjectCount();
+    result["draw_groups"] = geometryRenderer->getDrawnGroupCount();
+
+    context.makeCurrent(&surface);
+    delete document;
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    // the same context setup as the application, see main.cpp
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+    QSurfaceFormat surfaceFormat = QSurfaceFormat::defaultFormat();
+    surfaceFormat.setVersion(3, 3);
+    surfaceFormat.setProfile(QSurfaceFormat::CompatibilityProfile);
+    QSurfaceFormat::setDefaultFormat(surfaceFormat);
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times loading and rendering .g files offscreen and prints the results as JSON.");
+    parser.addHelpOption();
+    QCommandLineOption framesOption("frames", "Number of frames rendered while orbiting each model.", "count", "100");
+    QCommandLineOption sizeOption("size", "Size of the rendered frames.", "WxH", "1280x720");
+    QCommandLineOption outputOption("output", "Write the JSON to this file instead of stdout.", "file");
+    QCommandLineOption traceOption("trace", "Also record a Chrome trace of the run to this file.", "file");
+    parser.addOption(framesOption);
+    parser.addOption(sizeOption);
+    parser.addOption(outputOption);
+    parser.addOption(traceOption);
+    parser.addPositionalArgument("files", "Databases to measure, the models in extra/db by default.", "[file.g...]");
+    parser.process(app);
+
+    QStringList filePaths = parser.positionalArguments();
+    if (filePaths.isEmpty()) {
+        for (const char *model : {"goliath.g", "m35.g", "moss.g"}) {
+            filePaths.append(QString(ARBALEST_BENCH_DB_DIR) + "/" + model);
+        }
+    }
+    const int frameCount = std::max(1, parser.value(framesOption).toInt());
+    if (parser.isSet(traceOption)) {
+        Trace::setEnabled(true);
+        Trace::setThreadName("GUI");
+    }
+    const QStringList size = parser.value(sizeOption).split('x');
+    const int width = size.size() == 2 ? std::max(1, size[0].toInt()) : 1280;
+    const int height = size.size() == 2 ? std::max(1, size[1].toInt()) : 720;
+
+    QOffscreenSurface surface;
+    surface.setFormat(QSurfaceFormat::defaultFormat());
+    surface.create();
+    // shares with the viewports, like their own contexts would
+    QOpenGLContext context;
+    context.setFormat(QSurfaceFormat::defaultFormat());
+    context.setShareContext(QOpenGLContext::globalShareContext());
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        std::cerr << "arbalest_bench: could not create an OpenGL context" << std::endl;
+        return 1;
+    }
+    QOpenGLFramebufferObject framebuffer(width, height, QOpenGLFramebufferObject::CombinedDepthStencil);
+
+    loadTheme();
+    GeometryCache geometryCache;
+    Globals::geometryCache = &geometryCache;
+    RepaintScheduler repaintScheduler;
+    Globals::repaintScheduler = &repaintScheduler;
+    // kept apart from the documents' cache, so measuring the upload does not affect them
+    GeometryCache uploadCache;
+
+    QJsonArray models;
+    for (const QString &filePath : filePaths) {
+        QJsonObject model;
+        model["file"] = QFileInfo(filePath).fileName();
+        model["stages"] = measureStages(filePath, uploadCache, context.functions());
+        if (model["stages"].toObject().isEmpty()) {
+            std::cerr << "arbalest_bench: could not load " << filePath.toStdString() << std::endl;
+            continue;
+        }
+        model["document"] = measureDocument(filePath, context, surface, framebuffer, frameCount);
+        models.append(model);
+    }
+
+    QSettings settings("BRLCAD", "arbalest");
+    QOpenGLFunctions *functions = context.functions();
+    QJsonObject report;
+    report["qt_version"] = QString(qVersion());
+    report["gl_vendor"] = QString(reinterpret_cast<const char *>(functions->glGetString(GL_VENDOR)));
+    report["gl_renderer"] = QString(reinterpret_cast<const char *>(functions->glGetString(GL_RENDERER)));
+    report["gl_version"] = QString(reinterpret_cast<const char *>(functions->glGetString(GL_VERSION)));
+    report["width"] = width;
+    report["height"] = height;
+    // these change the numbers a lot, so they are recorded with them
+    report["shader_pipeline"] = settings.value("shaderPipeline", true).toBool();
+    report["tessellation_cache"] = settings.value("tessellationCache", true).toBool();
+    report["compact_vertices"] = settings.value("compactVertices", false).toBool();
+    report["occlusion_culling"] = settings.value("occlusionCulling", true).toBool();
+    report["geometry_budget_bytes"] = static_cast<qint64>(geometryCache.getBudgetBytes());
+    // over all models, the documents share the cache like in the application
+    report["peak_geometry_bytes"] = static_cast<qint64>(geometryCache.getPeakUsedBytes());
+    report["peak_resident_bytes"] = static_cast<qint64>(geometryCache.getPeakResidentBytes());
+    report["evicted_objects"] = static_cast<qint64>(geometryCache.getEvictedCount());
+    report["models"] = models;
+
+    if (parser.isSet(traceOption)) Trace::exportChromeJson(parser.value(traceOption));
+
+    const QByteArray json = QJsonDocument(report).toJson();
+    if (parser.isSet(outputOption)) {
+        QFile outputFile(parser.value(outputOption));
+        if (!outputFile.open(QFile::WriteOnly)) {
+            std::cerr << "arbalest_bench: could not write " << parser.value(outputOption).toStdString() << std::endl;
+            return 1;
+        }
+        outputFile.write(json);
+    }
+    else {
+        std::cout << json.constData();
+    }
+    return models.size() == filePaths.size() ? 0 : 1;
+}
@@ -30,6 +30,7 @@ HelpWidget::HelpWidget(QWidget* parent) : QVBoxWidget(parent) {
            "Use keys <font style=\"color:$Color-ColorText\">1 2 3 4</font> to switch between viewports<br><br>"
            "Open all viewports in quad view <font style=\"color:$Color-ColorText\">5</font> <br><br>"
            "Toggle grid on / off <font style=\"color:$Color-ColorText\">G</font> <br><br>"
+           "Show frame statistics of the viewport <font style=\"color:$Color-ColorText\">F12</font> <br><br>"
            "<br><br>"
            "Raytrace current viewport <font style=\"color:$Color-ColorText\">Ctrl+R</font> <br><br>"
 
@@ -552,6 +552,34 @@ void MainWindow::prepareUi()
     });
     viewMenu->addAction(toggleGridAct);
 
+    QAction *toggleStatisticsAct = new QAction(tr("Toggle frame statistics"), this);
+    toggleStatisticsAct->setStatusTip(tr("Show frame times and drawn geometry in the active viewport"));
+    toggleStatisticsAct->setShortcut(Qt::Key_F12);
+    connect(toggleStatisticsAct, &QAction::triggered, this, [this]() {
+        if (activeDocumentId == -1)
+            return;
+
+        Viewport *viewport = documents[activeDocumentId]->getViewportGrid()->getActiveViewport();
+        viewport->statisticsEnabled = !viewport->statisticsEnabled;
+        viewport->forceRerenderFrame();
+    });
+    viewMenu->addAction(toggleStatisticsAct);
+
+    QAction *toggleCompactVerticesAct = new QAction(tr("Toggle compact vertices"), this);
+    toggleCompactVerticesAct->setStatusTip(tr("Keep the geometry of the current document in half the GPU memory, "
+                                              "at 16 bit precision within each object"));
+    connect(toggleCompactVerticesAct, &QAction::triggered, this, [this]() {
+        if (activeDocumentId == -1)
+            return;
+
+        GeometryRenderer *geometryRenderer = documents[activeDocumentId]->getGeometryRenderer();
+        geometryRenderer->setCompactVertices(!geometryRenderer->getCompactVertices());
+        statusBar->showMessage(geometryRenderer->getCompactVertices() ? "Using compact vertices" : "Using float vertices",
+                               statusBarShortMessageDuration);
+        documents[activeDocumentId]->getViewportGrid()->forceRerenderAllViewports();
+    });
+    viewMenu->addAction(toggleCompactVerticesAct);
+
     QMenu *selectThemeAct = viewMenu->addMenu(tr("Select theme"));
     QActionGroup *selectThemeActGroup = new QActionGroup(this);
 
@@ -589,9 +617,8 @@ void MainWindow::prepareUi()
         if (activeDocumentId == -1)
             return;
         statusBar->showMessage("Raytracing current viewport...", statusBarShortMessageDuration);
-        QCoreApplication::processEvents();
+        // returns right away, the raytrace window shows the progress
         documents[activeDocumentId]->getRaytraceWidget()->raytrace();
-        statusBar->showMessage("Raytracing completed.", statusBarShortMessageDuration);
     });
     raytrace->addAction(raytraceAct);
 
@@ -601,9 +628,65 @@ void MainWindow::prepareUi()
         QColor color = settings.value("raytraceBackground").value<QColor>();
         QColor selectedColor = QColorDialog::getColor(color);
         settings.setValue("raytraceBackground", selectedColor);
+        for (const auto &document : documents) document.second->getRaytraceWidget()->reshade();
     });
     raytrace->addAction(setRaytraceBackgroundColorAct);
 
+    QMenu *selectRaytraceShadingAct = raytrace->addMenu(tr("Select raytrace shading"));
+    QActionGroup *selectRaytraceShadingActGroup = new QActionGroup(this);
+    const QStringList raytraceShadingNames = {tr("Phong"), tr("Diffuse"), tr("Surface normals")};
+    for (int shadingModel = 0; shadingModel < raytraceShadingNames.size(); shadingModel++) {
+        QAction *raytraceShadingAct = new QAction(raytraceShadingNames[shadingModel], this);
+        raytraceShadingAct->setCheckable(true);
+        raytraceShadingAct->setChecked(settings.value("raytraceShadingModel", TiledRaytracer::PhongShading).toInt() ==
+                                       shadingModel);
+        connect(raytraceShadingAct, &QAction::triggered, this, [this, shadingModel]() {
+            QSettings settings("BRLCAD", "arbalest");
+            settings.setValue("raytraceShadingModel", shadingModel);
+            for (const auto &document : documents) document.second->getRaytraceWidget()->reshade();
+        });
+        selectRaytraceShadingActGroup->addAction(raytraceShadingAct);
+        selectRaytraceShadingAct->addAction(raytraceShadingAct);
+    }
+
+    QAction *setRaytraceLightingAct = new QAction(tr("Set raytrace lighting.."), this);
+    setRaytraceLightingAct->setStatusTip(tr("Weights of the ambient, diffuse and specular light"));
+    connect(setRaytraceLightingAct, &QAction::triggered, this, [this]() {
+        QSettings settings("BRLCAD", "arbalest");
+        QDialog dialog(this);
+        dialog.setWindowTitle(tr("Raytrace lighting"));
+        QFormLayout *layout = new QFormLayout(&dialog);
+
+        const QStringList weightKeys = {"raytraceAmbient", "raytraceDiffuseWeight", "raytraceSpecularWeight"};
+        const QStringList weightNames = {tr("Ambient"), tr("Diffuse"), tr("Specular")};
+        const TiledRaytracer::Shading defaultShading;
+        const float defaultWeights[] = {defaultShading.ambient, defaultShading.diffuseWeight,
+                                        defaultShading.specularWeight};
+        QDoubleSpinBox *weightBoxes[3];
+        for (int i = 0; i < 3; i++) {
+            weightBoxes[i] = new QDoubleSpinBox(&dialog);
+            weightBoxes[i]->setRange(0., 2.);
+            weightBoxes[i]->setSingleStep(0.05);
+            weightBoxes[i]->setValue(settings.value(weightKeys[i], defaultWeights[i]).toDouble());
+            layout->addRow(weightNames[i], weightBoxes[i]);
+        }
+        QSpinBox *shininessBox = new QSpinBox(&dialog);
+        shininessBox->setRange(1, 256);
+        shininessBox->setValue(settings.value("raytraceShininess", defaultShading.shininess).toInt());
+        layout->addRow(tr("Shininess"), shininessBox);
+
+        QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+        connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+        connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+        layout->addRow(buttonBox);
+        if (dialog.exec() != QDialog::Accepted) return;
+
+        for (int i = 0; i < 3; i++) settings.setValue(weightKeys[i], weightBoxes[i]->value());
+        settings.setValue("raytraceShininess", shininessBox->value());
+        for (const auto &document : documents) document.second->getRaytraceWidget()->reshade();
+    });
+    raytrace->addAction(setRaytraceLightingAct);
+
     QMenu *help = menuTitleBar->addMenu(tr("&Help"));
     QAction *aboutAct = new QAction(tr("About"), this);
     connect(aboutAct, &QAction::triggered, this, [this]() { (new AboutWindow())->show(); });
@@ -672,6 +755,12 @@ void MainWindow::prepareUi()
     statusBarPathLabel = new QLabel("No document open");
     statusBarPathLabel->setObjectName("statusBarPathLabel");
     statusBar->addWidget(statusBarPathLabel);
+    loadingProgressBar = new QProgressBar();
+    loadingProgressBar->setObjectName("loadingProgressBar");
+    loadingProgressBar->setFormat("Loading geometry %v/%m");
+    loadingProgressBar->setMaximumWidth(250);
+    loadingProgressBar->hide();
+    statusBar->addPermanentWidget(loadingProgressBar);
 
     // Document area
     // --------------------------------------------------------------------------------------------------------
@@ -915,7 +1004,6 @@ void MainWindow::saveAsFileDialog()
     {
         if (saveFile(filePath))
         {
-            documents[activeDocumentId]->setFilePath(filePath);
             QString filename(QFileInfo(filePath).fileName());
             documentArea->setTabText(documentArea->currentIndex(), filename);
             statusBarPathLabel->setText(*documents[activeDocumentId]->getFilePath());
@@ -932,7 +1020,6 @@ bool MainWindow::saveAsFileDialogId(int documentId)
     {
         if (saveFileId(filePath, documentId))
         {
-            documents[documentId]->setFilePath(filePath);
             QString filename(QFileInfo(filePath).fileName());
             documentArea->setTabText(documentArea->currentIndex(), filename);
             statusBarPathLabel->setText(*documents[documentId]->getFilePath());
@@ -1053,6 +1140,10 @@ void MainWindow::onActiveDocumentChanged(const int newIndex)
                     action->setChecked(false);
                 singleViewAct[documents[activeDocumentId]->getViewportGrid()->getActiveViewportId()]->setChecked(true);
             }
+
+            GeometryRenderer *geometryRenderer = documents[activeDocumentId]->getGeometryRenderer();
+            updateLoadingProgress(activeDocumentId, geometryRenderer->getStreamedObjectCount(),
+                                  geometryRenderer->getStreamTotal());
         }
     }
     else if (activeDocumentId != -1)
@@ -1060,10 +1151,25 @@ void MainWindow::onActiveDocumentChanged(const int newIndex)
         objectTreeWidgetDockable->clear();
         objectPropertiesDockable->clear();
         statusBarPathLabel->setText("");
+        loadingProgressBar->hide();
         activeDocumentId = -1;
     }
 }
 
+void MainWindow::updateLoadingProgress(const int documentId, const int loadedObjectCount, const int totalObjectCount)
+{
+    if (documentId != activeDocumentId) return;
+
+    if (loadedObjectCount >= totalObjectCount)
+    {
+        loadingProgressBar->hide();
+        return;
+    }
+    loadingProgressBar->setRange(0, totalObjectCount);
+    loadingProgressBar->setValue(loadedObjectCount);
+    loadingProgressBar->show();
+}
+
 void MainWindow::tabCloseRequested(const int i)
 {
     int documentId = -1;
@@ -1089,6 +1195,7 @@ void MainWindow::tabCloseRequested(const int i)
         objectTreeWidgetDockable->clear();
         objectPropertiesDockable->clear();
         statusBarPathLabel->setText("");
+        loadingProgressBar->hide();
         activeDocumentId = -1;
     }
 }
@@ -2,7 +2,12 @@
 
 #include <QApplication>
 #include <QOpenGLWidget>
+#include <QSurfaceFormat>
 #include "MainWindow.h"
+#include "GeometryCache.h"
+#include "Globals.h"
+#include "RepaintScheduler.h"
+#include "Trace.h"
 
 int main(int argc, char*argv[]) {
 
@@ -14,10 +19,32 @@ int main(int argc, char*argv[]) {
 #endif
 
 
+    // every viewport of every document draws from the same buffers, so all GL contexts have to share
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+    // 3.3 for the shader pipeline, compatibility profile for everything still using the fixed function pipeline
+    QSurfaceFormat surfaceFormat = QSurfaceFormat::defaultFormat();
+    surfaceFormat.setVersion(3, 3);
+    surfaceFormat.setProfile(QSurfaceFormat::CompatibilityProfile);
+    QSurfaceFormat::setDefaultFormat(surfaceFormat);
+
+    // ARBALEST_TRACE=trace.json records timings of this session for chrome://tracing
+    const QString traceFilePath = qEnvironmentVariable("ARBALEST_TRACE");
+    if (!traceFilePath.isEmpty()) {
+        Trace::setEnabled(true);
+        Trace::setThreadName("GUI");
+    }
+
     QApplication app(argc,argv);
+    GeometryCache geometryCache;
+    Globals::geometryCache = &geometryCache;
+    RepaintScheduler repaintScheduler;
+    Globals::repaintScheduler = &repaintScheduler;
     MainWindow mainWindow;
     mainWindow.showMaximized();
-    return app.exec();
+    const int exitCode = app.exec();
+
+    if (!traceFilePath.isEmpty()) Trace::exportChromeJson(traceFilePath);
+    return exitCode;
 }
 
 /*
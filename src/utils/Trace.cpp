@@ -0,0 +1,169 @@
+/*                       T R A C E . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file Trace.cpp */
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "Trace.h"
+
+namespace {
+    struct Event {
+        const char *name;
+        qint64 startNs;
+        qint64 endNs;
+    };
+
+    /*
+     * Written only by its thread. Readers check written before and after copying and drop what may have been
+     * overwritten meanwhile, so the writer never waits.
+     */
+    struct ThreadBuffer {
+        int threadId = 0;
+        // guarded by the registry mutex
+        QString threadName;
+        std::atomic<quint64> written{0};
+        Event events[Trace::RING_BUFFER_EVENTS];
+        // buffers of threads that ended are handed to new threads
+        std::atomic<bool> inUse{true};
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<ThreadBuffer *> buffers;
+        int nextThreadId = 1;
+    };
+
+    Registry &registry() {
+        static Registry registry;
+        return registry;
+    }
+
+    struct ThreadBufferHolder {
+        ThreadBuffer *buffer = nullptr;
+
+        ~ThreadBufferHolder() {
+            if (buffer != nullptr) buffer->inUse.store(false, std::memory_order_release);
+        }
+    };
+    thread_local ThreadBufferHolder threadBufferHolder;
+
+    ThreadBuffer *threadBuffer() {
+        if (threadBufferHolder.buffer != nullptr) return threadBufferHolder.buffer;
+
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        ThreadBuffer *buffer = nullptr;
+        for (ThreadBuffer *unusedBuffer : registry().buffers) {
+            if (unusedBuffer->inUse.load(std::memory_order_acquire)) continue;
+            buffer = unusedBuffer;
+            buffer->written.store(0, std::memory_order_relaxed);
+            buffer->threadName.clear();
+            buffer->inUse.store(true, std::memory_order_relaxed);
+            break;
+        }
+        if (buffer == nullptr) {
+            buffer = new ThreadBuffer();
+            registry().buffers.push_back(buffer);
+        }
+        buffer->threadId = registry().nextThreadId++;
+        threadBufferHolder.buffer = buffer;
+        return buffer;
+    }
+
+    const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+}
+
+std::atomic<bool> Trace::enabled{false};
+
+
+Trace::Scope::Scope(const char *name) : name(name), startNs(Trace::isEnabled() ? Trace::nowNs() : -1) {}
+
+Trace::Scope::~Scope() {
+    if (startNs >= 0) Trace::record(name, startNs, Trace::nowNs());
+}
+
+void Trace::setEnabled(bool enabled) {
+    Trace::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::setThreadName(const QString &name) {
+    ThreadBuffer *buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer->threadName = name;
+}
+
+bool Trace::exportChromeJson(const QString &filePath) {
+    QJsonArray traceEvents;
+    const qint64 processId = QCoreApplication::applicationPid();
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        for (ThreadBuffer *buffer : registry().buffers) {
+            const quint64 writtenBefore = buffer->written.load(std::memory_order_acquire);
+            const quint64 first = writtenBefore > RING_BUFFER_EVENTS ? writtenBefore - RING_BUFFER_EVENTS : 0;
+            std::vector<Event> events;
+            events.reserve(writtenBefore - first);
+            for (quint64 i = first; i < writtenBefore; i++) events.push_back(buffer->events[i % RING_BUFFER_EVENTS]);
+
+            // everything the thread may have written over while copying is dropped, including the slot of the
+            // event it may be writing right now
+            const quint64 writtenAfter = buffer->written.load(std::memory_order_acquire);
+            const quint64 firstIntact =
+                writtenAfter + 1 > RING_BUFFER_EVENTS ? writtenAfter + 1 - RING_BUFFER_EVENTS : 0;
+            if (events.empty() && buffer->threadName.isEmpty()) continue;
+
+            if (!buffer->threadName.isEmpty()) {
+                traceEvents.append(QJsonObject{
+                    {"name", "thread_name"}, {"ph", "M"}, {"pid", processId}, {"tid", buffer->threadId},
+                    {"args", QJsonObject{{"name", buffer->threadName}}}
+                });
+            }
+            for (quint64 i = std::max(first, firstIntact); i < writtenBefore; i++) {
+                const Event &event = events[i - first];
+                traceEvents.append(QJsonObject{
+                    {"name", event.name}, {"ph", "X"}, {"pid", processId}, {"tid", buffer->threadId},
+                    {"ts", event.startNs / 1000.}, {"dur", (event.endNs - event.startNs) / 1000.}
+                });
+            }
+        }
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(QJsonDocument(QJsonObject{{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}}).toJson(
+        QJsonDocument::Compact));
+    return true;
+}
+
+qint64 Trace::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void Trace::record(const char *name, qint64 startNs, qint64 endNs) {
+    ThreadBuffer *buffer = threadBuffer();
+    const quint64 index = buffer->written.load(std::memory_order_relaxed);
+    buffer->events[index % RING_BUFFER_EVENTS] = {name, startNs, endNs};
+    buffer->written.store(index + 1, std::memory_order_release);
+}
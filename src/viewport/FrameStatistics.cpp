@@ -0,0 +1,186 @@
+/*               F R A M E S T A T I S T I C S . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file FrameStatistics.cpp */
+
+#include <algorithm>
+#include <QLocale>
+#include "FrameStatistics.h"
+
+static const int OVERLAY_MARGIN = 8;
+static const int OVERLAY_PADDING = 6;
+static const int HISTOGRAM_HEIGHT = 40;
+static const int HISTOGRAM_BAR_WIDTH = 2;
+// the histogram is scaled to at least one 60 Hz frame, which is also marked
+static const float TARGET_FRAME_MS = 1000.f / 60.f;
+
+
+FrameStatistics::FrameStatistics() {
+    std::fill(std::begin(cpuHistory), std::end(cpuHistory), -1.f);
+    std::fill(std::begin(gpuHistory), std::end(gpuHistory), -1.f);
+}
+
+void FrameStatistics::beginFrame(const GeometryCache &geometryCache, bool reducedDetail) {
+    if (!timerQueriesCreated) {
+        timerQueriesCreated = true;
+        timerQueriesSupported = true;
+        for (QOpenGLTimerQuery &timerQuery : timerQueries) {
+            if (!timerQuery.create()) timerQueriesSupported = false;
+        }
+    }
+
+    collectTimerQueries();
+    const int frame = historyFrameCount;
+    cpuHistory[frame % HISTORY_SIZE] = -1.f;
+    gpuHistory[frame % HISTORY_SIZE] = -1.f;
+    reducedDetailHistory[frame % HISTORY_SIZE] = reducedDetail;
+
+    // if every query is still in flight this frame just goes without GPU time
+    runningTimerQuery = -1;
+    for (int i = 0; timerQueriesSupported && i < TIMER_QUERY_COUNT; i++) {
+        if (timerQueryFrames[i] != -1) continue;
+        timerQueries[i].begin();
+        timerQueryFrames[i] = frame;
+        runningTimerQuery = i;
+        break;
+    }
+
+    frameStartDrawCalls = geometryCache.getDrawCallCount();
+    frameStartIndices = geometryCache.getSubmittedIndexCount();
+    cpuTimer.start();
+}
+
+void FrameStatistics::endFrame(const GeometryCache &geometryCache, int drawnObjectCount, int culledObjectCount,
+                               int occludedObjectCount) {
+    cpuHistory[historyFrameCount % HISTORY_SIZE] = cpuTimer.nsecsElapsed() / 1e6f;
+    if (runningTimerQuery != -1) timerQueries[runningTimerQuery].end();
+
+    drawCalls = geometryCache.getDrawCallCount() - frameStartDrawCalls;
+    submittedVertices = geometryCache.getSubmittedIndexCount() - frameStartIndices;
+    usedBytes = geometryCache.getUsedBytes();
+    peakUsedBytes = geometryCache.getPeakUsedBytes();
+    budgetBytes = geometryCache.getBudgetBytes();
+    residentBytes = geometryCache.residentBytes();
+    peakResidentBytes = geometryCache.getPeakResidentBytes();
+    evictedCount = geometryCache.getEvictedCount();
+    drawnObjects = drawnObjectCount;
+    culledObjects = culledObjectCount;
+    occludedObjects = occludedObjectCount;
+    historyFrameCount++;
+}
+
+float FrameStatistics::latestFullDetailFrameMs() const {
+    const int firstFrame = std::max(0, historyFrameCount - HISTORY_SIZE);
+    float latestCpuMs = 0.f;
+    bool latestCpuFound = false;
+    for (int frame = historyFrameCount - 1; frame >= firstFrame; frame--) {
+        const int slot = frame % HISTORY_SIZE;
+        if (reducedDetailHistory[slot]) continue;
+        if (!timerQueriesSupported) return cpuHistory[slot];
+        // the GPU time of the latest frames is not there yet, or was never measured
+        if (gpuHistory[slot] >= 0) return std::max(cpuHistory[slot], gpuHistory[slot]);
+        if (!latestCpuFound) {
+            latestCpuMs = cpuHistory[slot];
+            latestCpuFound = true;
+        }
+    }
+    return latestCpuMs;
+}
+
+void FrameStatistics::collectTimerQueries() {
+    for (int i = 0; i < TIMER_QUERY_COUNT; i++) {
+        if (timerQueryFrames[i] == -1 || !timerQueries[i].isResultAvailable()) continue;
+
+        const int frame = timerQueryFrames[i];
+        const GLuint64 nanoseconds = timerQueries[i].waitForResult();
+        if (historyFrameCount - frame < HISTORY_SIZE) gpuHistory[frame % HISTORY_SIZE] = nanoseconds / 1e6f;
+        timerQueryFrames[i] = -1;
+    }
+}
+
+void FrameStatistics::paint(QPainter &painter) const {
+    if (historyFrameCount == 0) return;
+    const int frameCount = std::min(historyFrameCount, HISTORY_SIZE);
+    const int firstFrame = historyFrameCount - frameCount;
+
+    float latestGpuMs = -1.f;
+    float scaleMs = TARGET_FRAME_MS;
+    for (int frame = firstFrame; frame < historyFrameCount; frame++) {
+        const int slot = frame % HISTORY_SIZE;
+        if (gpuHistory[slot] >= 0) latestGpuMs = gpuHistory[slot];
+        scaleMs = std::max({scaleMs, cpuHistory[slot], gpuHistory[slot]});
+    }
+
+    const QLocale locale;
+    const float cpuMs = cpuHistory[(historyFrameCount - 1) % HISTORY_SIZE];
+    QString gpuText = timerQueriesSupported ? "..." : "n/a";
+    if (latestGpuMs >= 0) gpuText = QString("%1 ms").arg(latestGpuMs, 0, 'f', 2);
+    const QStringList lines = {
+        QString("CPU %1 ms   GPU %2").arg(cpuMs, 0, 'f', 2).arg(gpuText),
+        QString("objects %1 drawn, %2 culled, %3 occluded").arg(locale.toString(drawnObjects),
+                                                               locale.toString(culledObjects),
+                                                               locale.toString(occludedObjects)),
+        QString("vertices %1   draw calls %2").arg(locale.toString(submittedVertices), locale.toString(drawCalls)),
+        QString("geometry %1 of %2, peak %3").arg(locale.formattedDataSize(usedBytes),
+                                                  locale.formattedDataSize(budgetBytes),
+                                                  locale.formattedDataSize(peakUsedBytes)),
+        QString("resident %1, peak %2   evicted %3").arg(locale.formattedDataSize(residentBytes),
+                                                         locale.formattedDataSize(peakResidentBytes),
+                                                         locale.toString(evictedCount))
+    };
+
+    painter.save();
+    QFont font("Monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    font.setPointSize(8);
+    painter.setFont(font);
+    const QFontMetrics metrics(font);
+    int textWidth = HISTORY_SIZE * HISTOGRAM_BAR_WIDTH;
+    for (const QString &line : lines) textWidth = std::max(textWidth, metrics.horizontalAdvance(line));
+
+    const QRect panel(OVERLAY_MARGIN, OVERLAY_MARGIN, textWidth + 2 * OVERLAY_PADDING,
+                      lines.size() * metrics.lineSpacing() + HISTOGRAM_HEIGHT + 3 * OVERLAY_PADDING);
+    painter.fillRect(panel, QColor(0, 0, 0, 160));
+
+    painter.setPen(Qt::white);
+    int baseline = panel.top() + OVERLAY_PADDING + metrics.ascent();
+    for (const QString &line : lines) {
+        painter.drawText(panel.left() + OVERLAY_PADDING, baseline, line);
+        baseline += metrics.lineSpacing();
+    }
+
+    // oldest frame on the left, GPU time drawn over CPU time
+    const int histogramBottom = panel.bottom() - OVERLAY_PADDING;
+    for (int frame = firstFrame; frame < historyFrameCount; frame++) {
+        const int slot = frame % HISTORY_SIZE;
+        const int x = panel.left() + OVERLAY_PADDING + (frame - firstFrame) * HISTOGRAM_BAR_WIDTH;
+        if (cpuHistory[slot] >= 0) {
+            const int height = std::max(1, static_cast<int>(cpuHistory[slot] / scaleMs * HISTOGRAM_HEIGHT));
+            painter.fillRect(x, histogramBottom - height, HISTOGRAM_BAR_WIDTH, height, QColor(90, 170, 255));
+        }
+        if (gpuHistory[slot] >= 0) {
+            const int height = std::max(1, static_cast<int>(gpuHistory[slot] / scaleMs * HISTOGRAM_HEIGHT));
+            painter.fillRect(x, histogramBottom - height, HISTOGRAM_BAR_WIDTH, 1, QColor(255, 170, 60));
+        }
+    }
+    const int targetY = histogramBottom - static_cast<int>(TARGET_FRAME_MS / scaleMs * HISTOGRAM_HEIGHT);
+    painter.setPen(QColor(255, 255, 255, 90));
+    painter.drawLine(panel.left() + OVERLAY_PADDING, targetY, panel.right() - OVERLAY_PADDING, targetY);
+    painter.restore();
+}
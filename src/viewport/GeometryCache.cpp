@@ -0,0 +1,461 @@
+/*                 G E O M E T R Y C A C H E . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file GeometryCache.cpp */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QSettings>
+#include "GeometryCache.h"
+
+#ifndef GL_TEXTURE_BUFFER
+#define GL_TEXTURE_BUFFER 0x8C2A
+#endif
+#ifndef GL_RGBA32F
+#define GL_RGBA32F 0x8814
+#endif
+
+struct CompactVertex {
+    // fraction of the bounding box of the entry, 0 is the minimum and 65535 the maximum
+    GLushort position[3];
+    GLushort decodeSlot;
+    GLshort normal[2];
+};
+
+static const GLsizei VERTEX_BYTES[] = {GeometryData::FLOATS_PER_VERTEX * sizeof(GLfloat), sizeof(CompactVertex)};
+static const GLushort NO_NORMAL_FLAG = 0x8000;
+// offset and scale of a slot, each as one RGBA32F texel
+static const int DECODE_SLOT_BYTES = 8 * sizeof(GLfloat);
+
+static GLshort encodeSnorm(GLfloat value) {
+    return static_cast<GLshort>(std::lround(std::max(-1.f, std::min(1.f, value)) * 32767.f));
+}
+
+/*
+ * Projects the unit normal onto the octahedron |x| + |y| + |z| = 1 and unfolds its lower half over the corners of
+ * the upper one, so that x and y alone identify it. See geometry.vert for the inverse.
+ */
+static void encodeOctahedral(const GLfloat *normal, GLshort encoded[2]) {
+    const GLfloat length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+    GLfloat x = normal[0] / length;
+    GLfloat y = normal[1] / length;
+    if (normal[2] < 0) {
+        const GLfloat foldedX = (1.f - std::abs(y)) * (x >= 0 ? 1.f : -1.f);
+        y = (1.f - std::abs(x)) * (y >= 0 ? 1.f : -1.f);
+        x = foldedX;
+    }
+    encoded[0] = encodeSnorm(x);
+    encoded[1] = encodeSnorm(y);
+}
+
+/*
+ * Quantizes the vertices into the bounding box of the data and fills decodeRow with what the shader needs to
+ * restore them: the box minimum and the size of one quantization step.
+ */
+static QVector<CompactVertex> packCompactVertices(const GeometryData &data, int decodeSlot, GLfloat decodeRow[8]) {
+    const BoundingBox box = data.boundingBox();
+    GLfloat steps[3];
+    for (int i = 0; i < 3; i++) {
+        const GLfloat extent = box.maximum[i] - box.minimum[i];
+        steps[i] = extent > 0 ? extent / 65535.f : 0.f;
+        decodeRow[i] = box.minimum[i];
+        decodeRow[i + 4] = steps[i];
+    }
+    decodeRow[3] = 0;
+    decodeRow[7] = 0;
+
+    QVector<CompactVertex> vertices(data.vertexCount());
+    for (int vertex = 0; vertex < vertices.size(); vertex++) {
+        const GLfloat *source = &data.vertices[vertex * GeometryData::FLOATS_PER_VERTEX];
+        CompactVertex &compact = vertices[vertex];
+        for (int i = 0; i < 3; i++) {
+            const GLfloat step = steps[i] > 0 ? (source[i] - box.minimum[i]) / steps[i] : 0.f;
+            compact.position[i] = static_cast<GLushort>(std::lround(std::max(0.f, std::min(65535.f, step))));
+        }
+        compact.decodeSlot = static_cast<GLushort>(decodeSlot);
+        const GLfloat *normal = source + 3;
+        if (normal[0] == 0 && normal[1] == 0 && normal[2] == 0) {
+            compact.decodeSlot |= NO_NORMAL_FLAG;
+            compact.normal[0] = compact.normal[1] = 0;
+        }
+        else {
+            encodeOctahedral(normal, compact.normal);
+        }
+    }
+    return vertices;
+}
+
+
+bool GeometryCache::Entry::isValid() const {
+    return page != -1;
+}
+
+GLsizei GeometryCache::Entry::totalIndexCount() const {
+    GLsizei count = 0;
+    for (int primitive = 0; primitive < GeometryData::PrimitiveCount; primitive++) count += indexCount[primitive];
+    return count;
+}
+
+size_t GeometryCache::Entry::byteSize() const {
+    return vertexCount * VERTEX_BYTES[vertexFormat] + totalIndexCount() * sizeof(GLuint);
+}
+
+GeometryCache::GeometryCache() {
+    QSettings settings("BRLCAD", "arbalest");
+    budgetBytes = static_cast<size_t>(settings.value("geometryBudgetMB", DEFAULT_BUDGET_MB).toULongLong()) << 20;
+    clock.start();
+}
+
+GeometryCache::Entry GeometryCache::upload(const GeometryData &data, VertexFormat vertexFormat) {
+    Entry entry;
+    const int vertexCount = data.vertexCount();
+    const int indexCount = data.indexCount();
+    if (indexCount == 0) return entry;
+
+    int page = -1;
+    int vertexOffset = 0;
+    int indexOffset = 0;
+    for (int i = 0; i < pages.size() && page == -1; i++) {
+        if (pages[i].vertexFormat != vertexFormat) continue;
+        if (vertexFormat == CompactVertices && pages[i].freeDecodeSlots.isEmpty()) continue;
+        if (!allocateRange(pages[i].freeVertexRanges, vertexCount, vertexOffset)) continue;
+        if (!allocateRange(pages[i].freeIndexRanges, indexCount, indexOffset)) {
+            freeRange(pages[i].freeVertexRanges, vertexOffset, vertexCount);
+            continue;
+        }
+        page = i;
+    }
+    if (page == -1) {
+        page = createPage(std::max(vertexCount, PAGE_VERTEX_CAPACITY), std::max(indexCount, PAGE_INDEX_CAPACITY),
+                          vertexFormat);
+        allocateRange(pages[page].freeVertexRanges, vertexCount, vertexOffset);
+        allocateRange(pages[page].freeIndexRanges, indexCount, indexOffset);
+    }
+
+    // indices are rebased to the page so that ranges of different objects can be drawn in one call
+    QVector<GLuint> pageIndices;
+    pageIndices.reserve(indexCount);
+    int firstIndex = indexOffset;
+    for (int primitive = 0; primitive < GeometryData::PrimitiveCount; primitive++) {
+        entry.firstIndex[primitive] = firstIndex;
+        entry.indexCount[primitive] = data.indices[primitive].size();
+        for (GLuint index : data.indices[primitive]) pageIndices.append(index + vertexOffset);
+        firstIndex += data.indices[primitive].size();
+    }
+    entry.page = page;
+    entry.vertexFormat = vertexFormat;
+    entry.firstVertex = vertexOffset;
+    entry.vertexCount = vertexCount;
+
+    QOpenGLFunctions *functions = QOpenGLContext::currentContext()->functions();
+    const GLsizei vertexBytes = VERTEX_BYTES[vertexFormat];
+    functions->glBindBuffer(GL_ARRAY_BUFFER, pages[page].vertexBuffer);
+    if (vertexFormat == CompactVertices) {
+        entry.decodeSlot = pages[page].freeDecodeSlots.takeLast();
+        GLfloat decodeRow[8];
+        const QVector<CompactVertex> compactVertices = packCompactVertices(data, entry.decodeSlot, decodeRow);
+        functions->glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * vertexBytes, vertexCount * vertexBytes,
+                                   compactVertices.constData());
+        functions->glBindBuffer(GL_TEXTURE_BUFFER, pages[page].decodeBuffer);
+        functions->glBufferSubData(GL_TEXTURE_BUFFER, entry.decodeSlot * DECODE_SLOT_BYTES, DECODE_SLOT_BYTES,
+                                   decodeRow);
+        functions->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+    else {
+        functions->glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * vertexBytes, vertexCount * vertexBytes,
+                                   data.vertices.constData());
+    }
+    functions->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pages[page].indexBuffer);
+    functions->glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset * sizeof(GLuint), indexCount * sizeof(GLuint),
+                               pageIndices.constData());
+    functions->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    functions->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    boundPage = -1;
+
+    usedBytes += entry.byteSize();
+    peakUsedBytes = std::max(peakUsedBytes, usedBytes);
+    return entry;
+}
+
+void GeometryCache::release(Entry &entry) {
+    if (!entry.isValid()) return;
+
+    usedBytes -= entry.byteSize();
+    Page &page = pages[entry.page];
+    freeRange(page.freeVertexRanges, entry.firstVertex, entry.vertexCount);
+    freeRange(page.freeIndexRanges, entry.firstIndex[GeometryData::Lines], entry.totalIndexCount());
+    if (entry.decodeSlot != -1) page.freeDecodeSlots.append(entry.decodeSlot);
+    entry = Entry();
+    // deleted by the next enforceBudget(), which has a context
+    if (isEmpty(page)) emptyPagesPending = true;
+}
+
+void GeometryCache::addOwner(Owner *owner) {
+    owners.append(owner);
+}
+
+void GeometryCache::removeOwner(Owner *owner) {
+    owners.removeAll(owner);
+}
+
+void GeometryCache::enforceBudget() {
+    if (usedBytes <= budgetBytes) {
+        // e.g. the geometry of a closed document
+        if (emptyPagesPending) deleteEmptyPages();
+        return;
+    }
+
+    QVector<EvictionCandidate> candidates;
+    for (Owner *owner : owners) owner->collectEvictionCandidates(candidates);
+    std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate &a, const EvictionCandidate &b) {
+        return a.lastDrawn < b.lastDrawn;
+    });
+
+    const qint64 now = timestamp();
+    for (const EvictionCandidate &candidate : candidates) {
+        if (usedBytes <= budgetBytes || now - candidate.lastDrawn < EVICTION_MIN_AGE_MS) break;
+        candidate.owner->evict(candidate);
+        evictedCount++;
+    }
+    deleteEmptyPages();
+}
+
+void GeometryCache::deleteEmptyPages() {
+    QOpenGLFunctions *functions = QOpenGLContext::currentContext()->functions();
+    for (int i = 0; i < pages.size(); i++) {
+        Page &page = pages[i];
+        if (page.vertexBuffer == 0 || !isEmpty(page)) continue;
+
+        if (i == boundPage) unbind();
+        functions->glDeleteBuffers(1, &page.vertexBuffer);
+        functions->glDeleteBuffers(1, &page.indexBuffer);
+        if (page.vertexFormat == CompactVertices) {
+            functions->glDeleteBuffers(1, &page.decodeBuffer);
+            glDeleteTextures(1, &page.decodeTexture);
+        }
+        page = Page();
+    }
+    emptyPagesPending = false;
+}
+
+bool GeometryCache::isEmpty(const Page &page) {
+    return page.freeVertexRanges.size() == 1 && page.freeVertexRanges.first() == page.vertexCapacity &&
+           page.freeIndexRanges.size() == 1 && page.freeIndexRanges.first() == page.indexCapacity;
+}
+
+void GeometryCache::bindPage(int page, VertexInput vertexInput) {
+    if (page == boundPage && vertexInput == boundVertexInput) return;
+
+    QOpenGLExtraFunctions *functions = QOpenGLContext::currentContext()->extraFunctions();
+    if (vertexInput != boundVertexInput) disableVertexInput();
+    functions->glBindBuffer(GL_ARRAY_BUFFER, pages[page].vertexBuffer);
+    functions->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pages[page].indexBuffer);
+
+    const GLsizei vertexBytes = VERTEX_BYTES[pages[page].vertexFormat];
+    if (vertexInput == FixedFunctionArrays) {
+        const void *normalOffset = reinterpret_cast<const void *>(3 * sizeof(GLfloat));
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glVertexPointer(3, GL_FLOAT, vertexBytes, nullptr);
+        glNormalPointer(GL_FLOAT, vertexBytes, normalOffset);
+    }
+    else if (pages[page].vertexFormat == FloatVertices) {
+        const void *normalOffset = reinterpret_cast<const void *>(3 * sizeof(GLfloat));
+        functions->glEnableVertexAttribArray(0);
+        functions->glEnableVertexAttribArray(1);
+        functions->glDisableVertexAttribArray(2);
+        functions->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexBytes, nullptr);
+        functions->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, vertexBytes, normalOffset);
+    }
+    else {
+        functions->glEnableVertexAttribArray(0);
+        functions->glEnableVertexAttribArray(1);
+        functions->glEnableVertexAttribArray(2);
+        functions->glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_FALSE, vertexBytes,
+                                         reinterpret_cast<const void *>(offsetof(CompactVertex, position)));
+        functions->glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, vertexBytes,
+                                         reinterpret_cast<const void *>(offsetof(CompactVertex, normal)));
+        functions->glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, vertexBytes,
+                                          reinterpret_cast<const void *>(offsetof(CompactVertex, decodeSlot)));
+        functions->glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, pages[page].decodeTexture);
+    }
+
+    boundPage = page;
+    boundVertexInput = vertexInput;
+    vertexInputEnabled = true;
+}
+
+void GeometryCache::unbind() {
+    disableVertexInput();
+
+    QOpenGLFunctions *functions = QOpenGLContext::currentContext()->functions();
+    functions->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    functions->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    boundPage = -1;
+}
+
+void GeometryCache::disableVertexInput() {
+    if (!vertexInputEnabled) return;
+
+    if (boundVertexInput == FixedFunctionArrays) {
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+    }
+    else {
+        QOpenGLFunctions *functions = QOpenGLContext::currentContext()->functions();
+        functions->glDisableVertexAttribArray(0);
+        functions->glDisableVertexAttribArray(1);
+        functions->glDisableVertexAttribArray(2);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+    vertexInputEnabled = false;
+}
+
+void GeometryCache::draw(GeometryData::Primitive primitive, const QVector<const Entry *> &entries) {
+    static const GLenum modes[GeometryData::PrimitiveCount] = {GL_LINES, GL_TRIANGLES, GL_POINTS};
+
+    QVector<GLsizei> counts;
+    QVector<const void *> offsets;
+    for (const Entry *entry : entries) {
+        if (entry->indexCount[primitive] == 0) continue;
+        submittedIndexCount += entry->indexCount[primitive];
+        counts.append(entry->indexCount[primitive]);
+        offsets.append(reinterpret_cast<const void *>(entry->firstIndex[primitive] * sizeof(GLuint)));
+    }
+    if (counts.isEmpty()) return;
+
+    if (!multiDrawElementsResolved) {
+        // glMultiDrawElements is OpenGL 1.4 and not part of QOpenGLFunctions
+        multiDrawElements = reinterpret_cast<MultiDrawElementsProc>(
+            QOpenGLContext::currentContext()->getProcAddress("glMultiDrawElements"));
+        multiDrawElementsResolved = true;
+    }
+
+    if (multiDrawElements != nullptr && counts.size() > 1) {
+        multiDrawElements(modes[primitive], counts.constData(), GL_UNSIGNED_INT, offsets.constData(), counts.size());
+        drawCallCount++;
+    }
+    else {
+        for (int i = 0; i < counts.size(); i++) glDrawElements(modes[primitive], counts[i], GL_UNSIGNED_INT, offsets[i]);
+        drawCallCount += counts.size();
+    }
+}
+
+void GeometryCache::drawInstanced(GeometryData::Primitive primitive, const Entry &entry, GLsizei instanceCount) {
+    static const GLenum modes[GeometryData::PrimitiveCount] = {GL_LINES, GL_TRIANGLES, GL_POINTS};
+    if (entry.indexCount[primitive] == 0 || instanceCount == 0) return;
+
+    QOpenGLExtraFunctions *functions = QOpenGLContext::currentContext()->extraFunctions();
+    functions->glDrawElementsInstanced(modes[primitive], entry.indexCount[primitive], GL_UNSIGNED_INT,
+                                       reinterpret_cast<const void *>(entry.firstIndex[primitive] * sizeof(GLuint)),
+                                       instanceCount);
+    submittedIndexCount += entry.indexCount[primitive] * static_cast<quint64>(instanceCount);
+    drawCallCount++;
+}
+
+size_t GeometryCache::residentBytes() const {
+    size_t bytes = 0;
+    for (const Page &page : pages) {
+        if (page.vertexBuffer == 0) continue;
+        bytes += page.vertexCapacity * VERTEX_BYTES[page.vertexFormat] + page.indexCapacity * sizeof(GLuint);
+        if (page.vertexFormat == CompactVertices) bytes += PAGE_DECODE_SLOT_CAPACITY * DECODE_SLOT_BYTES;
+    }
+    return bytes;
+}
+
+int GeometryCache::createPage(int vertexCapacity, int indexCapacity, VertexFormat vertexFormat) {
+    Page page;
+    page.vertexFormat = vertexFormat;
+    page.vertexCapacity = vertexCapacity;
+    page.indexCapacity = indexCapacity;
+    page.freeVertexRanges.insert(0, vertexCapacity);
+    page.freeIndexRanges.insert(0, indexCapacity);
+
+    QOpenGLExtraFunctions *functions = QOpenGLContext::currentContext()->extraFunctions();
+    functions->glGenBuffers(1, &page.vertexBuffer);
+    functions->glBindBuffer(GL_ARRAY_BUFFER, page.vertexBuffer);
+    functions->glBufferData(GL_ARRAY_BUFFER, vertexCapacity * VERTEX_BYTES[vertexFormat], nullptr, GL_STATIC_DRAW);
+    functions->glGenBuffers(1, &page.indexBuffer);
+    functions->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.indexBuffer);
+    functions->glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+
+    if (vertexFormat == CompactVertices) {
+        functions->glGenBuffers(1, &page.decodeBuffer);
+        functions->glBindBuffer(GL_TEXTURE_BUFFER, page.decodeBuffer);
+        functions->glBufferData(GL_TEXTURE_BUFFER, PAGE_DECODE_SLOT_CAPACITY * DECODE_SLOT_BYTES, nullptr,
+                                GL_STATIC_DRAW);
+        functions->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glGenTextures(1, &page.decodeTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, page.decodeTexture);
+        functions->glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, page.decodeBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        // taken from the back, so slots are used in order
+        for (int slot = PAGE_DECODE_SLOT_CAPACITY - 1; slot >= 0; slot--) page.freeDecodeSlots.append(slot);
+    }
+
+    int pageIndex = 0;
+    while (pageIndex < pages.size() && pages[pageIndex].vertexBuffer != 0) pageIndex++;
+    if (pageIndex == pages.size()) {
+        pages.append(page);
+    }
+    else {
+        pages[pageIndex] = page;
+    }
+    peakResidentBytes = std::max(peakResidentBytes, residentBytes());
+    return pageIndex;
+}
+
+// first fit
+bool GeometryCache::allocateRange(QMap<int, int> &freeRanges, int size, int &offset) {
+    for (QMap<int, int>::iterator it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it.value() < size) continue;
+
+        offset = it.key();
+        const int remaining = it.value() - size;
+        freeRanges.erase(it);
+        if (remaining > 0) freeRanges.insert(offset + size, remaining);
+        return true;
+    }
+    return false;
+}
+
+// gives the range back and merges it with adjacent free ranges
+void GeometryCache::freeRange(QMap<int, int> &freeRanges, int offset, int size) {
+    if (size == 0) return;
+
+    QMap<int, int>::iterator next = freeRanges.lowerBound(offset);
+    if (next != freeRanges.end() && offset + size == next.key()) {
+        size += next.value();
+        next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin()) {
+        QMap<int, int>::iterator previous = std::prev(next);
+        if (previous.key() + previous.value() == offset) {
+            previous.value() += size;
+            return;
+        }
+    }
+    freeRanges.insert(offset, size);
+}
@@ -0,0 +1,312 @@
+/*                  G E O M E T R Y D A T A . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file GeometryData.cpp */
+
+#include <algorithm>
+#include <cmath>
+#include <QHash>
+#include "GeometryData.h"
+
+// number of grid cells along the longest side of the bounding box for each simplified level
+static const int LEVEL_OF_DETAIL_RESOLUTIONS[GeometryData::MAX_LEVELS_OF_DETAIL - 1] = {48, 12};
+// a simplified level is only kept if it has at most this fraction of the indices of the previous level
+static const double LEVEL_OF_DETAIL_MIN_REDUCTION = .7;
+
+
+bool BoundingBox::isEmpty() const {
+    return minimum[0] > maximum[0];
+}
+
+void BoundingBox::extend(const GLfloat *point) {
+    for (int i = 0; i < 3; i++) {
+        if (point[i] < minimum[i]) minimum[i] = point[i];
+        if (point[i] > maximum[i]) maximum[i] = point[i];
+    }
+}
+
+void BoundingBox::extend(const BoundingBox &other) {
+    if (other.isEmpty()) return;
+    extend(other.minimum);
+    extend(other.maximum);
+}
+
+bool GeometryData::WeldKey::operator==(const WeldKey &other) const {
+    for (int i = 0; i < FLOATS_PER_VERTEX; i++) {
+        if (values[i] != other.values[i]) return false;
+    }
+    return true;
+}
+
+// qHash of a float treats 0 and -0 alike, so equal keys get equal hashes
+size_t qHash(const GeometryData::WeldKey &key, size_t seed) {
+    return qHashRange(key.values, key.values + GeometryData::FLOATS_PER_VERTEX, seed);
+}
+
+GeometryData::AppendElementCallback::AppendElementCallback(GeometryData *geometryData, AppendVars *vars) :
+    geometryData(geometryData), vars(vars) {}
+
+/*
+ * Tessellated solids repeat every vertex for each triangle around it. Vertices are compared after conversion
+ * to float, so only those that would be stored identically are merged, and hard edges keep one vertex per normal.
+ */
+GLuint GeometryData::AppendElementCallback::weldedVertex(const double *point, const double *normal) {
+    WeldKey key;
+    for (int i = 0; i < 3; i++) {
+        key.values[i] = static_cast<GLfloat>(point[i]);
+        key.values[i + 3] = static_cast<GLfloat>(normal[i]);
+    }
+    QHash<WeldKey, GLuint>::const_iterator welded = vars->weldedVertices.constFind(key);
+    if (welded != vars->weldedVertices.constEnd()) return welded.value();
+
+    const GLuint vertex = geometryData->addVertex(point, normal);
+    vars->weldedVertices.insert(key, vertex);
+    return vertex;
+}
+
+bool GeometryData::AppendElementCallback::operator()(BRLCAD::VectorList::Element *element) {
+    const double noNormal[3] = {0., 0., 0.};
+    if (!element) return true;
+
+    switch (element->Type()) {
+        case BRLCAD::VectorList::Element::ElementType::LineMove: {
+            BRLCAD::VectorList::LineMove *e = dynamic_cast<BRLCAD::VectorList::LineMove *> (element);
+            vars->lastLineVertex = weldedVertex(e->Point().coordinates, noNormal);
+            vars->lineStarted = true;
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::LineDraw: {
+            BRLCAD::VectorList::LineDraw *e = dynamic_cast<BRLCAD::VectorList::LineDraw *> (element);
+            const GLuint vertex = weldedVertex(e->Point().coordinates, noNormal);
+            if (vars->lineStarted) {
+                geometryData->indices[Lines].append(vars->lastLineVertex);
+                geometryData->indices[Lines].append(vertex);
+            }
+            vars->lastLineVertex = vertex;
+            vars->lineStarted = true;
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::PolygonStart: {
+            BRLCAD::VectorList::PolygonStart *e = dynamic_cast<BRLCAD::VectorList::PolygonStart *> (element);
+            for (int i = 0; i < 3; i++) vars->normal[i] = e->Normal().coordinates[i];
+            vars->polygonVertices.clear();
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::PolygonMove: {
+            BRLCAD::VectorList::PolygonMove *e = dynamic_cast<BRLCAD::VectorList::PolygonMove *> (element);
+            vars->polygonVertices.clear();
+            vars->polygonVertices.append(weldedVertex(e->Point().coordinates, vars->normal));
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::PolygonDraw: {
+            BRLCAD::VectorList::PolygonDraw *e = dynamic_cast<BRLCAD::VectorList::PolygonDraw *> (element);
+            vars->polygonVertices.append(weldedVertex(e->Point().coordinates, vars->normal));
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::PolygonEnd: {
+            BRLCAD::VectorList::PolygonEnd *e = dynamic_cast<BRLCAD::VectorList::PolygonEnd *> (element);
+            // the end point usually repeats the first point, which would only add a degenerate triangle
+            const BRLCAD::Vector3D point = e->Point();
+            bool closesPolygon = !vars->polygonVertices.isEmpty();
+            if (closesPolygon) {
+                const GLfloat *first = &geometryData->vertices[vars->polygonVertices.first() * FLOATS_PER_VERTEX];
+                for (int i = 0; i < 3; i++) {
+                    if (first[i] != static_cast<GLfloat>(point.coordinates[i])) closesPolygon = false;
+                }
+            }
+            if (!closesPolygon) vars->polygonVertices.append(weldedVertex(point.coordinates, vars->normal));
+
+            for (int i = 2; i < vars->polygonVertices.size(); i++) {
+                geometryData->indices[Triangles].append(vars->polygonVertices[0]);
+                geometryData->indices[Triangles].append(vars->polygonVertices[i - 1]);
+                geometryData->indices[Triangles].append(vars->polygonVertices[i]);
+            }
+            vars->polygonVertices.clear();
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::TriangleStart: {
+            BRLCAD::VectorList::TriangleStart *e = dynamic_cast<BRLCAD::VectorList::TriangleStart *> (element);
+            for (int i = 0; i < 3; i++) vars->normal[i] = e->Normal().coordinates[i];
+            vars->triangleVertices.clear();
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::TriangleMove: {
+            BRLCAD::VectorList::TriangleMove *e = dynamic_cast<BRLCAD::VectorList::TriangleMove *> (element);
+            vars->triangleVertices.clear();
+            vars->triangleVertices.append(weldedVertex(e->Point().coordinates, vars->normal));
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::TriangleDraw: {
+            BRLCAD::VectorList::TriangleDraw *e = dynamic_cast<BRLCAD::VectorList::TriangleDraw *> (element);
+            vars->triangleVertices.append(weldedVertex(e->Point().coordinates, vars->normal));
+            if (vars->triangleVertices.size() == 3) {
+                const QVector<GLuint> &triangle = vars->triangleVertices;
+                // welding turns triangles with repeated points into ones with repeated vertices
+                if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[0] != triangle[2]) {
+                    geometryData->indices[Triangles].append(triangle);
+                }
+                // keep the first vertex so that longer runs continue as a fan
+                vars->triangleVertices.remove(1);
+            }
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::TriangleEnd: {
+            vars->triangleVertices.clear();
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::PolygonVertexNormal: {
+            BRLCAD::VectorList::PolygonVertexNormal *e = dynamic_cast<BRLCAD::VectorList::PolygonVertexNormal *> (element);
+            for (int i = 0; i < 3; i++) vars->normal[i] = e->Normal().coordinates[i];
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::TriangleVertexNormal: {
+            BRLCAD::VectorList::TriangleVertexNormal *e = dynamic_cast<BRLCAD::VectorList::TriangleVertexNormal *> (element);
+            for (int i = 0; i < 3; i++) vars->normal[i] = e->Normal().coordinates[i];
+            break;
+        }
+        case BRLCAD::VectorList::Element::ElementType::PointDraw: {
+            BRLCAD::VectorList::PointDraw *e = dynamic_cast<BRLCAD::VectorList::PointDraw *> (element);
+            geometryData->indices[Points].append(weldedVertex(e->Point().coordinates, noNormal));
+            break;
+        }
+        default:
+            // display space annotations, line widths and point sizes are not produced when plotting solids
+            break;
+    }
+    return true;
+}
+
+void GeometryData::appendVectorList(BRLCAD::VectorList &vectorList) {
+    AppendElementCallback::AppendVars vars;
+    AppendElementCallback appendElementCallback(this, &vars);
+    vectorList.Iterate(appendElementCallback);
+}
+
+void GeometryData::clear() {
+    vertices.clear();
+    clusterCellSize = 0;
+    for (QVector<GLuint> &primitiveIndices : indices) primitiveIndices.clear();
+}
+
+bool GeometryData::isEmpty() const {
+    return indexCount() == 0;
+}
+
+int GeometryData::vertexCount() const {
+    return vertices.size() / FLOATS_PER_VERTEX;
+}
+
+int GeometryData::indexCount() const {
+    int count = 0;
+    for (const QVector<GLuint> &primitiveIndices : indices) count += primitiveIndices.size();
+    return count;
+}
+
+size_t GeometryData::byteSize() const {
+    return vertices.size() * sizeof(GLfloat) + indexCount() * sizeof(GLuint);
+}
+
+BoundingBox GeometryData::boundingBox() const {
+    BoundingBox box;
+    for (int i = 0; i < vertices.size(); i += FLOATS_PER_VERTEX) box.extend(&vertices[i]);
+    return box;
+}
+
+GeometryData GeometryData::simplified(GLfloat cellSize) const {
+    static const int primitiveVertexCounts[PrimitiveCount] = {2, 3, 1};
+
+    GeometryData result;
+    result.clusterCellSize = cellSize;
+    const BoundingBox box = boundingBox();
+    if (box.isEmpty()) return result;
+
+    // vertices are never shared between primitive types, so lines do not pick up normals of surfaces
+    for (int primitive = 0; primitive < PrimitiveCount; primitive++) {
+        const int primitiveVertexCount = primitiveVertexCounts[primitive];
+        QHash<quint64, GLuint> cellVertices;
+
+        for (int i = 0; i + primitiveVertexCount <= indices[primitive].size(); i += primitiveVertexCount) {
+            GLuint merged[3];
+            bool newVertex = false;
+            for (int j = 0; j < primitiveVertexCount; j++) {
+                const GLfloat *vertex = &vertices[indices[primitive][i + j] * FLOATS_PER_VERTEX];
+                quint64 cell = 0;
+                for (int k = 0; k < 3; k++) {
+                    cell = (cell << 21) | static_cast<quint64>(std::floor((vertex[k] - box.minimum[k]) / cellSize));
+                }
+
+                QHash<quint64, GLuint>::const_iterator cellVertex = cellVertices.constFind(cell);
+                if (cellVertex == cellVertices.constEnd()) {
+                    // the first vertex falling into a cell represents it
+                    merged[j] = result.vertexCount();
+                    for (int k = 0; k < FLOATS_PER_VERTEX; k++) result.vertices.append(vertex[k]);
+                    cellVertices.insert(cell, merged[j]);
+                    newVertex = true;
+                }
+                else {
+                    merged[j] = cellVertex.value();
+                }
+            }
+
+            if (primitive == Points && !newVertex) continue;
+            if (primitiveVertexCount > 1 && merged[0] == merged[1]) continue;
+            if (primitiveVertexCount > 2 && (merged[1] == merged[2] || merged[0] == merged[2])) continue;
+            for (int j = 0; j < primitiveVertexCount; j++) result.indices[primitive].append(merged[j]);
+        }
+    }
+    return result;
+}
+
+QVector<GeometryData> GeometryData::levelsOfDetail() const {
+    QVector<GeometryData> levels;
+    levels.append(*this);
+
+    const BoundingBox box = boundingBox();
+    if (box.isEmpty()) return levels;
+    GLfloat size = 0;
+    for (int i = 0; i < 3; i++) size = std::max(size, box.maximum[i] - box.minimum[i]);
+    if (size <= 0) return levels;
+
+    for (int resolution : LEVEL_OF_DETAIL_RESOLUTIONS) {
+        GeometryData level = simplified(size / resolution);
+        // a level that is empty would make the object disappear instead of looking coarse
+        if (level.isEmpty()) break;
+        if (level.indexCount() > LEVEL_OF_DETAIL_MIN_REDUCTION * levels.last().indexCount()) continue;
+        levels.append(level);
+    }
+    return levels;
+}
+
+QByteArray GeometryData::levelOfDetailParameters() {
+    QByteArray parameters;
+    for (int resolution : LEVEL_OF_DETAIL_RESOLUTIONS) parameters.append(QByteArray::number(resolution)).append(' ');
+    parameters.append(QByteArray::number(LEVEL_OF_DETAIL_MIN_REDUCTION));
+    return parameters;
+}
+
+GLuint GeometryData::addVertex(const double *point, const double *normal) {
+    const GLuint vertex = vertexCount();
+    vertices.append(static_cast<GLfloat>(point[0]));
+    vertices.append(static_cast<GLfloat>(point[1]));
+    vertices.append(static_cast<GLfloat>(point[2]));
+    vertices.append(static_cast<GLfloat>(normal[0]));
+    vertices.append(static_cast<GLfloat>(normal[1]));
+    vertices.append(static_cast<GLfloat>(normal[2]));
+    return vertex;
+}
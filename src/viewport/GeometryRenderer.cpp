@@ -19,63 +19,614 @@
  */
  /** @file GeometryRenderer.cpp */
 
+#include <QSettings>
+#include <QTimer>
+#include <QVector4D>
+#include <brlcad/Database/Combination.h>
 #include "GeometryRenderer.h"
+#include "Globals.h"
+#include "MainWindow.h"
+#include "Trace.h"
+#include "Utils.h"
 
 
-GeometryRenderer::GeometryRenderer(Document* document) : document(document)
+GeometryRenderer::GeometryRenderer(Document* document) : document(document), geometryCache(*Globals::geometryCache)
 {
+    lastFileObjectId = document->getObjectTree()->lastAllocatedId;
+    QSettings settings("BRLCAD", "arbalest");
+    compactVertices = settings.value("compactVertices", false).toBool();
+    if (document->getFilePath() != nullptr) tessellationPool = new TessellationPool(*document->getFilePath());
+    geometryCache.addOwner(this);
     refreshForVisibilityAndSolidChanges();
 }
 
+GeometryRenderer::~GeometryRenderer() {
+    geometryCache.removeOwner(this);
+    delete tessellationPool;
+    for (ObjectGeometry &objectGeometry : objectNameGeometryMap) {
+        for (GeometryCache::Entry &entry : objectGeometry.levels) geometryCache.release(entry);
+    }
+}
+
+/*
+ * Buffers live in the application wide share group, so an object uploaded while painting one viewport
+ * is drawn by all other viewports and documents without being plotted or uploaded again.
+ */
+void GeometryRenderer::render(Viewport *viewport) {
+    TRACE_SCOPE("GeometryRenderer::render");
+    ViewportManager *viewportManager = viewport->getViewportManager();
+    viewportManager->saveState();
+    // the other viewports draw whatever the active one has streamed in so far
+    if (viewport == document->getViewport()) {
+        const bool compact = compactVertices && viewportManager->hasShaderPipeline();
+        uploadVertexFormat = compact ? GeometryCache::CompactVertices : GeometryCache::FloatVertices;
+        streamObjects();
+        repaintAffectedViewports(viewport);
+    }
+
+    drawVisibleObjects(viewport);
+    // after drawing, so that what this frame needs is the last to be evicted
+    if (viewport == document->getViewport()) geometryCache.enforceBudget();
+    viewportManager->drawSuffix();
+    viewportManager->restoreState();
+}
+
 void GeometryRenderer::render() {
-    document->getViewport()->getViewportManager()->saveState();
-    if (!objectsToBeViewportedIds.empty()) {
-        for (int objectId : objectsToBeViewportedIds) {
-            if (!objectIdViewportListIdMap.contains(objectId)) {
-                drawSolid(objectId);
+    render(document->getViewport());
+}
+
+/*
+ * Drops all uploaded geometry, the visible objects are streamed in again in the new format. Objects of the file
+ * usually come back from the tessellation cache without being plotted.
+ */
+void GeometryRenderer::setCompactVertices(bool compactVertices) {
+    if (compactVertices == this->compactVertices) return;
+    this->compactVertices = compactVertices;
+
+    for (ObjectGeometry &objectGeometry : objectNameGeometryMap) {
+        for (GeometryCache::Entry &entry : objectGeometry.levels) geometryCache.release(entry);
+    }
+    objectNameGeometryMap.clear();
+    pendingLevelsOfDetail.clear();
+    refinementQueue.clear();
+    refreshForVisibilityAndSolidChanges();
+}
+
+int GeometryRenderer::getStreamedObjectCount() const {
+    return streamTotal - (objectsToBeViewportedIds.size() - nextObjectToBeViewported) - waitingObjectIds.size();
+}
+
+/*
+ * Plots and uploads queued objects until FRAME_BUDGET_MS is used up, so that opening a big model does not freeze
+ * the window. Whatever is left is continued in the next frame, which is requested right away.
+ */
+void GeometryRenderer::streamObjects() {
+    TRACE_SCOPE("GeometryRenderer::streamObjects");
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    bool unfinished = collectTessellatedObjects(frameTimer);
+
+    while (nextObjectToBeViewported < objectsToBeViewportedIds.size()) {
+        if (frameTimer.elapsed() >= FRAME_BUDGET_MS) {
+            unfinished = true;
+            break;
+        }
+
+        const int objectId = objectsToBeViewportedIds[nextObjectToBeViewported++];
+        const QString objectName = document->getObjectTree()->getNameMap()[objectId];
+        if (!isUploaded(objectName)) {
+            if (!plotOnGuiThread(objectId)) {
+                if (!pendingObjectNames.contains(objectName)) {
+                    tessellationPool->enqueue(objectName);
+                    pendingObjectNames.insert(objectName);
+                }
+                waitingObjectIds.append(objectId);
+                continue;
             }
-            visibleViewportListIds.append(objectIdViewportListIdMap[objectId]);
+            drawSolid(objectName);
         }
+        makeVisible(objectId);
+    }
+    if (nextObjectToBeViewported == objectsToBeViewportedIds.size()) {
         objectsToBeViewportedIds.clear();
+        nextObjectToBeViewported = 0;
+    }
+
+    for (QSet<int>::iterator it = evictedObjectIdsInView.begin(); it != evictedObjectIdsInView.end();) {
+        if (frameTimer.elapsed() >= FRAME_BUDGET_MS) {
+            unfinished = true;
+            break;
+        }
+
+        const int objectId = *it;
+        it = evictedObjectIdsInView.erase(it);
+        const QString objectName = document->getObjectTree()->getNameMap()[objectId];
+        if (isUploaded(objectName) || pendingObjectNames.contains(objectName)) continue;
+        if (plotOnGuiThread(objectId)) {
+            drawSolid(objectName);
+        }
+        else {
+            tessellationPool->enqueue(objectName);
+            pendingObjectNames.insert(objectName);
+        }
     }
+    if (!unfinished) unfinished = refineObjects(frameTimer);
 
-    for (int displayListId : visibleViewportListIds) {
-        document->getViewport()->getViewportManager()->drawDList(displayListId);
+    const int streamedObjectCount = getStreamedObjectCount();
+    if (streamedObjectCount != reportedStreamedObjectCount && Globals::mainWindow != nullptr) {
+        Globals::mainWindow->updateLoadingProgress(document->getDocumentId(), streamedObjectCount, streamTotal);
+        reportedStreamedObjectCount = streamedObjectCount;
     }
-    document->getViewport()->getViewportManager()->drawSuffix();
-    document->getViewport()->getViewportManager()->restoreState();
+
+    // objects waiting for the tessellation pool are continued by TessellationPool::resultsReady
+    if (unfinished) continueInNextFrame(document->getViewport());
 }
 
+void GeometryRenderer::continueInNextFrame(Viewport *viewport) {
+    QTimer::singleShot(0, viewport, [viewport]() {
+        viewport->forceRerenderFrame();
+    });
+}
 
-void GeometryRenderer::drawSolid(int objectId) {
-    const ColorInfo colorInfo = document->getObjectTree()->getColorMap()[objectId];
-    const QString objectFullPath = document->getObjectTree()->getFullPathMap()[objectId];
-    BRLCAD::VectorList vectorList;
-    document->getDatabase()->Plot(objectFullPath.toUtf8(), vectorList);
+bool GeometryRenderer::isUploaded(const QString &objectName) const {
+    QHash<QString, ObjectGeometry>::const_iterator objectGeometry = objectNameGeometryMap.constFind(objectName);
+    return objectGeometry != objectNameGeometryMap.constEnd() && !objectGeometry->evicted;
+}
+
+// false if all corners of the box lie outside of the same clip plane
+static bool intersectsFrustum(const BoundingBox &box, const QMatrix4x4 &viewProjection) {
+    int outsideCounts[6] = {0, 0, 0, 0, 0, 0};
+    for (int corner = 0; corner < 8; corner++) {
+        const QVector4D point = viewProjection * QVector4D((corner & 1) ? box.maximum[0] : box.minimum[0],
+                                                          (corner & 2) ? box.maximum[1] : box.minimum[1],
+                                                          (corner & 4) ? box.maximum[2] : box.minimum[2], 1.f);
+        if (point.x() < -point.w()) outsideCounts[0]++;
+        if (point.x() > point.w()) outsideCounts[1]++;
+        if (point.y() < -point.w()) outsideCounts[2]++;
+        if (point.y() > point.w()) outsideCounts[3]++;
+        if (point.z() < -point.w()) outsideCounts[4]++;
+        if (point.z() > point.w()) outsideCounts[5]++;
+    }
+    for (int outsideCount : outsideCounts) {
+        if (outsideCount == 8) return false;
+    }
+    return true;
+}
+
+static BoundingBox transformedBoundingBox(const BoundingBox &box, const QMatrix4x4 &matrix) {
+    if (box.isEmpty() || matrix.isIdentity()) return box;
+
+    BoundingBox result;
+    for (int corner = 0; corner < 8; corner++) {
+        const QVector3D point = matrix.map(QVector3D((corner & 1) ? box.maximum[0] : box.minimum[0],
+                                                     (corner & 2) ? box.maximum[1] : box.minimum[1],
+                                                     (corner & 4) ? box.maximum[2] : box.minimum[2]));
+        const GLfloat coordinates[3] = {point.x(), point.y(), point.z()};
+        result.extend(coordinates);
+    }
+    return result;
+}
+
+/*
+ * Only the active viewport streams, the other viewports of the document are repainted if geometry that changed
+ * meanwhile is in their view.
+ */
+void GeometryRenderer::repaintAffectedViewports(Viewport *streamingViewport) {
+    if (changedObjectNames.isEmpty()) return;
+
+    QVector<Viewport *> viewports;
+    QVector<QMatrix4x4> viewProjections;
+    for (Viewport *viewport : document->getViewportGrid()->getViewports()) {
+        if (viewport == streamingViewport) continue;
+        viewports.append(viewport);
+        viewProjections.append(viewport->getCamera()->projectionMatrix() * viewport->getCamera()->modelViewMatrix());
+    }
+
+    QHash<int, QString> &nameMap = document->getObjectTree()->getNameMap();
+    for (int objectId : visibleObjectIds) {
+        if (viewports.isEmpty()) break;
+        const QString &objectName = nameMap[objectId];
+        if (!changedObjectNames.contains(objectName)) continue;
+
+        const BoundingBox box = transformedBoundingBox(objectNameGeometryMap[objectName].boundingBox,
+                                                       placementMatrix(objectId));
+        for (int i = viewports.size() - 1; i >= 0; i--) {
+            if (!intersectsFrustum(box, viewProjections[i])) continue;
+            viewports[i]->forceRerenderFrame();
+            viewports.removeAt(i);
+            viewProjections.removeAt(i);
+        }
+    }
+    changedObjectNames.clear();
+}
+
+/*
+ * The leaf matrices of all combinations between the top object and objectId, multiplied in order.
+ * Results are kept until the object or one of its ancestors is cleared.
+ */
+QMatrix4x4 GeometryRenderer::placementMatrix(int objectId) {
+    QHash<int, QMatrix4x4>::const_iterator cached = objectIdPlacementMatrixMap.constFind(objectId);
+    if (cached != objectIdPlacementMatrixMap.constEnd()) return cached.value();
+
+    ObjectTree *objectTree = document->getObjectTree();
+    const int parentObjectId = objectTree->getParent()[objectId];
+    QMatrix4x4 matrix;
+    // top objects are not placed by a matrix
+    if (parentObjectId > 0) {
+        matrix = placementMatrix(parentObjectId);
+        const QString objectName = objectTree->getNameMap()[objectId];
+        document->getBRLCADConstObject(objectTree->getNameMap()[parentObjectId], [&matrix, &objectName](const BRLCAD::Object &object) {
+            const BRLCAD::Combination *combination = dynamic_cast<const BRLCAD::Combination *>(&object);
+            if (combination == nullptr) return;
+            BRLCAD::Combination::ConstTreeNode tree = combination->Tree();
+            const double *leafMatrix = getLeafMatrix(tree, objectName);
+            if (leafMatrix == nullptr) return;
+
+            // both are row major
+            QMatrix4x4 placement;
+            for (int i = 0; i < 16; i++) placement(i / 4, i % 4) = leafMatrix[i];
+            matrix *= placement;
+        });
+    }
+    objectIdPlacementMatrixMap[objectId] = matrix;
+    return matrix;
+}
+
+/*
+ * The bounding volume hierarchy follows the object tree: every node holds the union of the boxes of the visible
+ * objects below it, so a combination that is out of view is skipped with all its children.
+ */
+void GeometryRenderer::buildBoundingVolumeHierarchy() {
+    ObjectTree *objectTree = document->getObjectTree();
+    QHash<int, int> &parents = objectTree->getParent();
+    boundingVolumeHierarchy.clear();
+    for (int objectId : visibleObjectIds) {
+        const BoundingBox box = transformedBoundingBox(objectNameGeometryMap[objectTree->getNameMap()[objectId]].boundingBox,
+                                                       placementMatrix(objectId));
+        for (int nodeId = objectId; nodeId != -1; nodeId = parents[nodeId]) {
+            BoundingVolume &volume = boundingVolumeHierarchy[nodeId];
+            volume.box.extend(box);
+            volume.objectCount++;
+        }
+    }
+    boundingVolumeHierarchyOutdated = false;
+    sceneVersion++;
+}
+
+/*
+ * Subtrees the occlusion culler found hidden are skipped as well. If the latest query of such a subtree has not
+ * finished yet and conditional rendering is available, its objects go to conditionalNodes instead.
+ * openedNodeIds gets the visible internal nodes with more than one object, which are queried with the drawn
+ * objects so that a subtree hidden as a whole is found.
+ */
+void GeometryRenderer::cullObjects(const QMatrix4x4 &viewProjection, OcclusionCuller *occlusionCuller,
+                                   QVector<int> &drawnObjectIds, QVector<int> &openedNodeIds,
+                                   QVector<int> &occludedNodeIds, QVector<ConditionalNode> &conditionalNodes) {
+    if (boundingVolumeHierarchyOutdated) buildBoundingVolumeHierarchy();
+
+    culledObjectCount = 0;
+    occludedObjectCount = 0;
+    collectObjectsInFrustum(0, viewProjection, occlusionCuller, drawnObjectIds, openedNodeIds, occludedNodeIds,
+                            conditionalNodes);
+    drawnObjectCount = drawnObjectIds.size();
+    for (const ConditionalNode &conditionalNode : conditionalNodes) drawnObjectCount += conditionalNode.objectIds.size();
+}
+
+// with occlusionCuller nullptr rootId is included, otherwise only the subtree below it
+void GeometryRenderer::collectObjectsInFrustum(int rootId, const QMatrix4x4 &viewProjection,
+                                               OcclusionCuller *occlusionCuller, QVector<int> &drawnObjectIds,
+                                               QVector<int> &openedNodeIds, QVector<int> &occludedNodeIds,
+                                               QVector<ConditionalNode> &conditionalNodes) {
+    const QSet<int> &drawableObjectIds = document->getObjectTree()->getDrawableObjectIds();
+    document->getObjectTree()->traverseSubTree(rootId, occlusionCuller == nullptr, [&](int objectId) {
+        QHash<int, BoundingVolume>::const_iterator volume = boundingVolumeHierarchy.constFind(objectId);
+        if (volume == boundingVolumeHierarchy.constEnd()) return false;
+        if (!intersectsFrustum(volume->box, viewProjection)) {
+            culledObjectCount += volume->objectCount;
+            return false;
+        }
+        if (occlusionCuller != nullptr && occlusionCuller->isOccluded(objectId) &&
+            occlusionCuller->canBeOccluded(volume->box)) {
+            if (occlusionCuller->hasPendingQuery(objectId) && occlusionCuller->hasConditionalRender()) {
+                ConditionalNode conditionalNode;
+                conditionalNode.nodeId = objectId;
+                QVector<int> unusedOpenedNodeIds;
+                QVector<int> unusedOccludedNodeIds;
+                QVector<ConditionalNode> unusedConditionalNodes;
+                collectObjectsInFrustum(objectId, viewProjection, nullptr, conditionalNode.objectIds,
+                                        unusedOpenedNodeIds, unusedOccludedNodeIds, unusedConditionalNodes);
+                conditionalNodes.append(conditionalNode);
+            }
+            else {
+                occludedObjectCount += volume->objectCount;
+                occludedNodeIds.append(objectId);
+            }
+            return false;
+        }
+        if (drawableObjectIds.contains(objectId)) {
+            drawnObjectIds.append(objectId);
+        }
+        // a node with a single object has the box of that object
+        else if (volume->objectCount > 1) {
+            openedNodeIds.append(objectId);
+        }
+        return true;
+    });
+}
+
+/*
+ * The coarsest level whose merged grid cells stay below LEVEL_OF_DETAIL_PIXEL_ERROR on screen.
+ * A level that is not uploaded yet is replaced by the next coarser one.
+ */
+const GeometryCache::Entry &GeometryRenderer::levelOfDetail(const ObjectGeometry &objectGeometry, float pixelsPerUnit) {
+    int level = objectGeometry.levels.size() - 1;
+    while (level > 0 && objectGeometry.clusterCellSizes[level] * pixelsPerUnit > LEVEL_OF_DETAIL_PIXEL_ERROR) level--;
+    while (level < objectGeometry.levels.size() - 1 && !objectGeometry.levels[level].isValid()) level++;
+    return objectGeometry.levels[level];
+}
 
-    clearSolidIfAvailable(objectId);
+void GeometryRenderer::drawVisibleObjects(Viewport *viewport) {
+    TRACE_SCOPE("GeometryRenderer::drawVisibleObjects");
+    ViewportManager *viewportManager = viewport->getViewportManager();
+    const QMatrix4x4 viewProjection = viewport->getCamera()->projectionMatrix() * viewport->getCamera()->modelViewMatrix();
+    OcclusionCuller *occlusionCuller = viewportManager->getOcclusionCuller();
+    if (occlusionCuller != nullptr) occlusionCuller->beginFrame(viewProjection, sceneVersion);
 
-    const unsigned int displayListId = document->getViewport()->getViewportManager()->genDLists(1);
-    document->getViewport()->getViewportManager()->beginDList(displayListId);  // begin display list --------------
+    QVector<int> drawnObjectIds;
+    QVector<int> openedNodeIds;
+    QVector<int> occludedNodeIds;
+    QVector<ConditionalNode> conditionalNodes;
+    cullObjects(viewProjection, occlusionCuller, drawnObjectIds, openedNodeIds, occludedNodeIds, conditionalNodes);
+    const float pixelsPerUnit = viewport->getH() / viewport->getCamera()->getVerticalSpan();
+    // see Viewport::isReducedDetail()
+    const bool reducedDetail = viewport->isReducedDetail();
+    const qint64 now = geometryCache.timestamp();
+    const int evictedObjectsInView = evictedObjectIdsInView.size();
 
+    bool drawsSurfaces = false;
+    renderQueue.clear();
+    for (int objectId : drawnObjectIds) {
+        if (queueObject(renderQueue, objectId, pixelsPerUnit, reducedDetail, now)) drawsSurfaces = true;
+    }
+    renderQueue.draw(viewportManager, geometryCache);
+
+    for (const ConditionalNode &conditionalNode : conditionalNodes) {
+        conditionalRenderQueue.clear();
+        for (int objectId : conditionalNode.objectIds) {
+            queueObject(conditionalRenderQueue, objectId, pixelsPerUnit, reducedDetail, now);
+        }
+        occlusionCuller->beginConditionalRender(conditionalNode.nodeId);
+        conditionalRenderQueue.draw(viewportManager, geometryCache);
+        occlusionCuller->endConditionalRender();
+    }
+
+    if (occlusionCuller != nullptr) {
+        // wires hardly hide anything, so without surfaces the queries would only cost time
+        if (!drawsSurfaces) {
+            occlusionCuller->clear();
+        }
+        else if (occlusionCuller->needsQueries()) {
+            // internal nodes first, a hidden subtree is then skipped as a whole in the next frames
+            const QVector<int> queriedNodeIds = openedNodeIds + occludedNodeIds + drawnObjectIds;
+            QVector<BoundingBox> boxes;
+            boxes.reserve(queriedNodeIds.size());
+            for (int nodeId : queriedNodeIds) boxes.append(boundingVolumeHierarchy[nodeId].box);
+            occlusionCuller->issueQueries(queriedNodeIds, boxes);
+        }
+    }
+
+    // evicted objects are uploaded again by the active viewport, the others follow once they are
+    if (evictedObjectIdsInView.size() > evictedObjectsInView) continueInNextFrame(document->getViewport());
+    if (occlusionCuller != nullptr && occlusionCuller->needsNextFrame()) continueInNextFrame(viewport);
+}
+
+/*
+ * Adds the object at its level of detail for the frame. Returns true if it has surfaces.
+ */
+bool GeometryRenderer::queueObject(RenderQueue &queue, int objectId, float pixelsPerUnit, bool reducedDetail,
+                                   qint64 now) {
+    ObjectGeometry &objectGeometry = objectNameGeometryMap[document->getObjectTree()->getNameMap()[objectId]];
+    if (objectGeometry.evicted) {
+        evictedObjectIdsInView.insert(objectId);
+        return false;
+    }
+    objectGeometry.lastDrawn = now;
+    if (reducedDetail) {
+        const BoundingBox &box = boundingVolumeHierarchy[objectId].box;
+        const QVector3D diagonal(box.maximum[0] - box.minimum[0], box.maximum[1] - box.minimum[1],
+                                 box.maximum[2] - box.minimum[2]);
+        if (diagonal.length() * pixelsPerUnit < REDUCED_DETAIL_MIN_OBJECT_PIXELS) {
+            drawnObjectCount--;
+            culledObjectCount++;
+            return false;
+        }
+    }
+    float color[3];
+    objectColor(objectId, color);
+    const GeometryCache::Entry &level = reducedDetail ? objectGeometry.levels.last()
+                                                      : levelOfDetail(objectGeometry, pixelsPerUnit);
+    queue.add(&level, color, placementMatrix(objectId));
+    return level.indexCount[GeometryData::Triangles] > 0;
+}
+
+void GeometryRenderer::collectEvictionCandidates(QVector<GeometryCache::EvictionCandidate> &candidates) {
+    for (QHash<QString, ObjectGeometry>::const_iterator it = objectNameGeometryMap.constBegin();
+         it != objectNameGeometryMap.constEnd(); ++it) {
+        if (it->evicted) continue;
+        size_t bytes = 0;
+        for (const GeometryCache::Entry &entry : it->levels) {
+            if (entry.isValid()) bytes += entry.byteSize();
+        }
+        if (bytes > 0) candidates.append({this, it.key(), it->lastDrawn, bytes});
+    }
+}
+
+/*
+ * Levels of detail that were not uploaded yet are dropped as well, they come back with the coarsest level.
+ */
+void GeometryRenderer::evict(const GeometryCache::EvictionCandidate &candidate) {
+    ObjectGeometry &objectGeometry = objectNameGeometryMap[candidate.objectName];
+    for (GeometryCache::Entry &entry : objectGeometry.levels) geometryCache.release(entry);
+    objectGeometry.evicted = true;
+    sceneVersion++;
+    pendingLevelsOfDetail.remove(candidate.objectName);
+}
+
+void GeometryRenderer::objectColor(int objectId, float color[3]) {
+    const ColorInfo colorInfo = document->getObjectTree()->getColorMap()[objectId];
     if (colorInfo.hasColor) {
-        document->getViewport()->getViewportManager()->setFGColor(colorInfo.red, colorInfo.green, colorInfo.blue, 1);
+        color[0] = colorInfo.red;
+        color[1] = colorInfo.green;
+        color[2] = colorInfo.blue;
     }
     else {
-        document->getViewport()->getViewportManager()->setFGColor(defaultWireColor[0], defaultWireColor[1], defaultWireColor[2], 1);
+        for (int i = 0; i < 3; i++) color[i] = defaultWireColor[i];
     }
+}
+
+void GeometryRenderer::drawSolid(const QString &objectName) {
+    TRACE_SCOPE("GeometryRenderer::drawSolid");
+    BRLCAD::VectorList vectorList;
+    document->getDatabase()->Plot(objectName.toUtf8(), vectorList);
 
     //displayManager->setLineStyle(tsp->ts_sofar & (TS_SOFAR_MINUS | TS_SOFAR_INTER));
-    document->getViewport()->getViewportManager()->drawVList(&vectorList);
-    document->getViewport()->getViewportManager()->endDList();     // end display list --------------
+    GeometryData geometryData;
+    geometryData.appendVectorList(vectorList);
+    uploadGeometry(objectName, geometryData.levelsOfDetail());
+}
 
-    objectIdViewportListIdMap[objectId] = displayListId;
+/*
+ * Only the coarsest level is uploaded right away, so every object shows up as early as possible.
+ * The finer levels follow in refineObjects() once all queued objects are drawn.
+ */
+void GeometryRenderer::uploadGeometry(const QString &objectName, const QVector<GeometryData> &levelsOfDetail) {
+    if (objectNameGeometryMap.contains(objectName)) {
+        for (GeometryCache::Entry &entry : objectNameGeometryMap[objectName].levels) geometryCache.release(entry);
+    }
+    ObjectGeometry &objectGeometry = objectNameGeometryMap[objectName];
+    objectGeometry = ObjectGeometry();
+    objectGeometry.levels.resize(levelsOfDetail.size());
+    for (const GeometryData &level : levelsOfDetail) objectGeometry.clusterCellSizes.append(level.clusterCellSize);
+    objectGeometry.levels.last() = geometryCache.upload(levelsOfDetail.last(), uploadVertexFormat);
+    objectGeometry.boundingBox = levelsOfDetail.first().boundingBox();
+    objectGeometry.lastDrawn = geometryCache.timestamp();
+    sceneVersion++;
+    changedObjectNames.insert(objectName);
+
+    pendingLevelsOfDetail.remove(objectName);
+    if (levelsOfDetail.size() > 1) {
+        pendingLevelsOfDetail[objectName] = levelsOfDetail.mid(0, levelsOfDetail.size() - 1);
+        refinementQueue.push_back(objectName);
+    }
+}
+
+/*
+ * Uploads the next finer level of detail of objects, one level per object in turn.
+ * Returns true if the frame budget ran out before all levels were uploaded.
+ */
+bool GeometryRenderer::refineObjects(const QElapsedTimer &frameTimer) {
+    while (!refinementQueue.empty()) {
+        if (frameTimer.elapsed() >= FRAME_BUDGET_MS) return true;
+
+        const QString objectName = refinementQueue.front();
+        refinementQueue.pop_front();
+        QHash<QString, QVector<GeometryData>>::iterator pendingLevels = pendingLevelsOfDetail.find(objectName);
+        // cleared in the meantime
+        if (pendingLevels == pendingLevelsOfDetail.end()) continue;
+
+        objectNameGeometryMap[objectName].levels[pendingLevels->size() - 1] = geometryCache.upload(pendingLevels->last(), uploadVertexFormat);
+        pendingLevels->removeLast();
+        changedObjectNames.insert(objectName);
+        if (pendingLevels->isEmpty()) {
+            pendingLevelsOfDetail.erase(pendingLevels);
+        }
+        else {
+            refinementQueue.push_back(objectName);
+        }
+    }
+    return false;
+}
+
+void GeometryRenderer::makeVisible(int objectId) {
+    const QString objectName = document->getObjectTree()->getNameMap()[objectId];
+    if (!objectNameGeometryMap[objectName].levels.last().isValid()) return;
+    visibleObjectIds.append(objectId);
+    boundingVolumeHierarchyOutdated = true;
+    changedObjectNames.insert(objectName);
+}
+
+/*
+ * Uploads what the tessellation pool plotted since the last frame and starts drawing the visible objects
+ * that were waiting for it. Only the upload happens on the GL thread.
+ * Returns true if the frame budget ran out before everything that is ready was handled.
+ */
+bool GeometryRenderer::collectTessellatedObjects(const QElapsedTimer &frameTimer) {
+    if (tessellationPool == nullptr) return false;
+
+    for (TessellationPool::Result &result : tessellationPool->takeResults()) {
+        tessellatedResults.push_back(std::move(result));
+    }
+    if (tessellatedResults.empty()) return false;
+
+    bool unfinished = false;
+    while (!tessellatedResults.empty()) {
+        if (frameTimer.elapsed() >= FRAME_BUDGET_MS) {
+            unfinished = true;
+            break;
+        }
+
+        const TessellationPool::Result &result = tessellatedResults.front();
+        // the object was changed while a worker was plotting the version on disk
+        if (pendingObjectNames.remove(result.objectName)) {
+            if (result.plotted) {
+                uploadGeometry(result.objectName, result.levelsOfDetail);
+            }
+            else {
+                staleObjectNames.insert(result.objectName);
+            }
+        }
+        tessellatedResults.pop_front();
+    }
+
+    QVector<int> stillWaitingObjectIds;
+    for (int objectId : waitingObjectIds) {
+        const QString objectName = document->getObjectTree()->getNameMap()[objectId];
+        if (!isUploaded(objectName)) {
+            if (pendingObjectNames.contains(objectName)) {
+                stillWaitingObjectIds.append(objectId);
+                continue;
+            }
+            // a worker could not plot it
+            if (frameTimer.elapsed() >= FRAME_BUDGET_MS) {
+                stillWaitingObjectIds.append(objectId);
+                unfinished = true;
+                continue;
+            }
+            drawSolid(objectName);
+        }
+        makeVisible(objectId);
+    }
+    waitingObjectIds = stillWaitingObjectIds;
+    return unfinished;
+}
+
+bool GeometryRenderer::plotOnGuiThread(int objectId) const {
+    return tessellationPool == nullptr || objectId > lastFileObjectId ||
+           staleObjectNames.contains(document->getObjectTree()->getNameMap()[objectId]);
 }
 
 
 
 void GeometryRenderer::refreshForVisibilityAndSolidChanges() {
-    visibleViewportListIds.clear();
+    visibleObjectIds.clear();
+    boundingVolumeHierarchyOutdated = true;
+    waitingObjectIds.clear();
+    evictedObjectIdsInView.clear();
+    objectsToBeViewportedIds.clear();
+    nextObjectToBeViewported = 0;
+    if (tessellationPool != nullptr) {
+        for (const QString &objectName : tessellationPool->cancelQueued()) pendingObjectNames.remove(objectName);
+    }
     document->getObjectTree()->traverseSubTree(0, false,[this]
         (int objectId)
         {
@@ -85,20 +636,30 @@ void GeometryRenderer::refreshForVisibilityAndSolidChanges() {
             return true;
         }
     );
+    streamTotal = objectsToBeViewportedIds.size();
+    reportedStreamedObjectCount = -1;
 }
 
+/*
+ * Drops the geometry of the object, which also affects all other places the object is used at, and its placement.
+ */
 void GeometryRenderer::clearSolidIfAvailable(int objectId) {
-    if (objectIdViewportListIdMap.contains(objectId)){
-        document->getViewport()->getViewportManager()->freeDLists(objectIdViewportListIdMap[objectId], 1);
-        objectIdViewportListIdMap.remove(objectId);
+    const QString objectName = document->getObjectTree()->getNameMap()[objectId];
+    if (objectNameGeometryMap.contains(objectName)){
+        for (GeometryCache::Entry &entry : objectNameGeometryMap[objectName].levels) geometryCache.release(entry);
+        objectNameGeometryMap.remove(objectName);
+        pendingLevelsOfDetail.remove(objectName);
     }
+    objectIdPlacementMatrixMap.remove(objectId);
 }
 
 void GeometryRenderer::clearObject(int objectId) {
     document->getObjectTree()->traverseSubTree(objectId, true, [this](int objectId){
         clearSolidIfAvailable(objectId);
+        // the file on disk no longer matches, so it has to be plotted from the document's database
+        const QString objectName = document->getObjectTree()->getNameMap()[objectId];
+        staleObjectNames.insert(objectName);
+        pendingObjectNames.remove(objectName);
         return true;
     });
 }
-
-
@@ -37,6 +37,13 @@ void GridRenderer::render() {
         alpha = (abs(std::fmod(abs(display->getCamera()->getAnglesAroundAxes()[0]),180)-90)/90.)*.7;
     }
 
+    // with shaders the whole grid is a single quad, so its cost does not depend on the number of lines
+    const float gridColor[] = {lineColor[0], lineColor[1], lineColor[2], alpha};
+    if (display->getViewportManager()->drawGrid(lineGap, length / 2, gridColor)) {
+        display->getViewportManager()->restoreState();
+        return;
+    }
+
     glColor4f(lineColor[0],lineColor[1],lineColor[2],alpha);
     glBegin(GL_LINES);
     for (double i = -lineCount*lineGap/2; i < lineCount*lineGap/2; i+=lineGap){
@@ -56,6 +56,7 @@ bool MoveCameraMouseAction::eventFilter(QObject* watched, QEvent* event) {
                     m_watched->getCamera()->processMoveRequest(x - prevMouseX, y - prevMouseY);
                 }
 
+                m_watched->interact();
                 m_watched->forceRerenderFrame();
 
                 const QPoint topLeft = m_watched->mapToGlobal(QPoint(0, 0));
@@ -110,6 +111,7 @@ bool MoveCameraMouseAction::eventFilter(QObject* watched, QEvent* event) {
             prevMouseY = -1;
             ret        = true;
 
+            m_watched->endInteraction();
             emit Done(this);
         }
         else if (event->type() == QEvent::Wheel) {
@@ -119,6 +121,7 @@ bool MoveCameraMouseAction::eventFilter(QObject* watched, QEvent* event) {
                 wheelMouseEvent->phase() == Qt::ScrollUpdate || 
                 wheelMouseEvent->phase() == Qt::ScrollMomentum) {
                 m_watched->getCamera()->processZoomRequest(wheelMouseEvent->angleDelta().y() / 8);
+                m_watched->interact();
                 m_watched->forceRerenderFrame();
             }
 
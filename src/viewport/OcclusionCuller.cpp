@@ -0,0 +1,205 @@
+/*               O C C L U S I O N C U L L E R . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file OcclusionCuller.cpp */
+
+#include <QOpenGLContext>
+#include <QVector4D>
+#include "OcclusionCuller.h"
+
+#ifndef GL_ANY_SAMPLES_PASSED
+#define GL_ANY_SAMPLES_PASSED 0x8C2F
+#endif
+#ifndef GL_SAMPLES_PASSED
+#define GL_SAMPLES_PASSED 0x8914
+#endif
+#ifndef GL_QUERY_NO_WAIT
+#define GL_QUERY_NO_WAIT 0x8E14
+#endif
+
+
+OcclusionCuller::OcclusionCuller() {
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    // the boxes are drawn in immediate mode
+    if (context->isOpenGLES()) return;
+    initializeOpenGLFunctions();
+
+    // any samples passed is OpenGL 3.3 and may stop counting early, counting all samples works since 1.5
+    queryTarget = context->format().version() >= qMakePair(3, 3) ? GL_ANY_SAMPLES_PASSED : GL_SAMPLES_PASSED;
+    if (context->format().version() >= qMakePair(3, 0)) {
+        beginConditionalRenderProc = reinterpret_cast<BeginConditionalRenderProc>(
+            context->getProcAddress("glBeginConditionalRender"));
+        endConditionalRenderProc = reinterpret_cast<EndConditionalRenderProc>(
+            context->getProcAddress("glEndConditionalRender"));
+        if (endConditionalRenderProc == nullptr) beginConditionalRenderProc = nullptr;
+    }
+    valid = true;
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    for (const NodeState &nodeState : nodeStates) {
+        if (nodeState.query != 0) glDeleteQueries(1, &nodeState.query);
+    }
+}
+
+void OcclusionCuller::beginFrame(const QMatrix4x4 &viewProjection, int sceneVersion) {
+    if (viewProjection != frameViewProjection || sceneVersion != frameSceneVersion) viewNumber++;
+    frameNumber++;
+
+    bool stateChanged = false;
+    QVector<int> stillPendingNodeIds;
+    for (int nodeId : pendingNodeIds) {
+        NodeState &nodeState = nodeStates[nodeId];
+        GLuint available = 0;
+        glGetQueryObjectuiv(nodeState.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            stillPendingNodeIds.append(nodeId);
+            continue;
+        }
+
+        GLuint samples = 0;
+        glGetQueryObjectuiv(nodeState.query, GL_QUERY_RESULT, &samples);
+        nodeState.pending = false;
+        // a result for an earlier view may still show the node, but hiding it needs a query of this view
+        const bool occluded = samples == 0 && nodeState.queriedViewNumber == viewNumber;
+        if (occluded != nodeState.occluded) {
+            nodeState.occluded = occluded;
+            stateChanged = true;
+        }
+    }
+    pendingNodeIds = stillPendingNodeIds;
+
+    frameViewProjection = viewProjection;
+    frameSceneVersion = sceneVersion;
+    queriesNeeded = stateChanged || outdatedQueriesSkipped || viewProjection != queriedViewProjection ||
+                    sceneVersion != queriedSceneVersion;
+    nextFrameNeeded = false;
+}
+
+bool OcclusionCuller::isOccluded(int nodeId) {
+    QHash<int, NodeState>::iterator nodeState = nodeStates.find(nodeId);
+    if (nodeState == nodeStates.end()) return false;
+
+    // skipped in the previous frame, so its result may be from long ago
+    if (nodeState->visitedFrameNumber + 1 != frameNumber) nodeState->occluded = false;
+    nodeState->visitedFrameNumber = frameNumber;
+    return nodeState->occluded;
+}
+
+bool OcclusionCuller::canBeOccluded(const BoundingBox &box) const {
+    for (int corner = 0; corner < 8; corner++) {
+        const QVector4D clipCorner = frameViewProjection * QVector4D(
+            (corner & 1) ? box.maximum[0] : box.minimum[0], (corner & 2) ? box.maximum[1] : box.minimum[1],
+            (corner & 4) ? box.maximum[2] : box.minimum[2], 1.f);
+        // in front of the near plane, or behind the eye with a perspective projection
+        if (clipCorner.z() < -clipCorner.w() || clipCorner.w() <= 0.f) return false;
+    }
+    return true;
+}
+
+bool OcclusionCuller::hasPendingQuery(int nodeId) const {
+    QHash<int, NodeState>::const_iterator nodeState = nodeStates.constFind(nodeId);
+    return nodeState != nodeStates.constEnd() && nodeState->pending;
+}
+
+void OcclusionCuller::beginConditionalRender(int nodeId) {
+    beginConditionalRenderProc(nodeStates[nodeId].query, GL_QUERY_NO_WAIT);
+}
+
+void OcclusionCuller::endConditionalRender() {
+    endConditionalRenderProc();
+}
+
+void OcclusionCuller::issueQueries(const QVector<int> &nodeIds, const QVector<BoundingBox> &boxes) {
+    if (!queriesNeeded) return;
+    queriedViewProjection = frameViewProjection;
+    queriedSceneVersion = frameSceneVersion;
+    queriesNeeded = false;
+    outdatedQueriesSkipped = false;
+
+    // the boxes only test the depth buffer. Equal depths pass, so that a box which coincides with the faces of
+    // its own object is not hidden by them
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_BLEND);
+
+    for (int i = 0; i < nodeIds.size(); i++) {
+        NodeState &nodeState = nodeStates[nodeIds[i]];
+        if (!canBeOccluded(boxes[i])) {
+            // visible whatever is in front of it
+            if (nodeState.occluded) nextFrameNeeded = true;
+            nodeState.occluded = false;
+            continue;
+        }
+        // its result would be lost. If it is for an earlier view, the node is queried again once it finished
+        if (nodeState.pending) {
+            if (nodeState.queriedViewNumber != viewNumber) outdatedQueriesSkipped = true;
+            continue;
+        }
+        if (nodeState.query == 0) glGenQueries(1, &nodeState.query);
+
+        glBeginQuery(queryTarget, nodeState.query);
+        drawBox(boxes[i]);
+        glEndQuery(queryTarget);
+        nodeState.pending = true;
+        nodeState.queriedViewNumber = viewNumber;
+        pendingNodeIds.append(nodeIds[i]);
+    }
+
+    glPopAttrib();
+}
+
+void OcclusionCuller::clear() {
+    for (NodeState &nodeState : nodeStates) {
+        // this frame skipped what was occluded, the next one draws it
+        if (nodeState.occluded) nextFrameNeeded = true;
+        nodeState.occluded = false;
+        nodeState.pending = false;
+    }
+    pendingNodeIds.clear();
+    queriedSceneVersion = -1;
+}
+
+bool OcclusionCuller::needsNextFrame() const {
+    return nextFrameNeeded || !pendingNodeIds.isEmpty();
+}
+
+void OcclusionCuller::drawBox(const BoundingBox &box) {
+    // corner i takes the maximum on the axes of its set bits
+    GLfloat corners[8][3];
+    for (int corner = 0; corner < 8; corner++) {
+        for (int axis = 0; axis < 3; axis++) {
+            corners[corner][axis] = (corner & (1 << axis)) ? box.maximum[axis] : box.minimum[axis];
+        }
+    }
+    static const int faces[6][4] = {
+        {0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5}
+    };
+
+    glBegin(GL_QUADS);
+    for (const int *face : faces) {
+        for (int i = 0; i < 4; i++) glVertex3fv(corners[face[i]]);
+    }
+    glEnd();
+}
@@ -28,12 +28,13 @@
  *      implementation of the graphical visualization
  */
 
-#include <cmath>
-
 #include <QPainter>
 #include <QMessageBox>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
 
 #include "RaytraceView.h"
+#include "Trace.h"
 #include <QBitmap>
 #include <QtWidgets/QFileDialog>
 #include <QtOpenGL/QtOpenGL>
@@ -44,19 +45,41 @@ RaytraceView::RaytraceView
     QWidget*               parent
 ) : QWidget(parent),
     document(document),
-    m_database(*document->getDatabase()),
-    m_transformation(),
-    m_image(),
-    m_imageUpTodate(false),
-    m_updatingImage(false) {
+    m_transformation() {
     setMinimumSize(100, 100);
     setWindowIcon(*new QIcon(*new QBitmap(":/icons/arbalest_icon.png")));
     setWindowFlags(Qt::Window| Qt::WindowCloseButtonHint);
+
+    statusLabel  = new QLabel(this);
+    cancelButton = new QPushButton("Cancel", this);
+    saveButton   = new QPushButton("Save image..", this);
+    connect(cancelButton, &QPushButton::clicked, this, &RaytraceView::cancel);
+    connect(saveButton, &QPushButton::clicked, this, &RaytraceView::saveImage);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(statusLabel);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(cancelButton);
+    buttonLayout->addWidget(saveButton);
+    // the image is painted above the buttons
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addStretch();
+    layout->addLayout(buttonLayout);
+
+    // shows the tiles of a pass while they are traced
+    previewTimer.setInterval(PREVIEW_INTERVAL_MS);
+    connect(&previewTimer, &QTimer::timeout, this, QOverload<>::of(&QWidget::update));
+}
+
+
+RaytraceView::~RaytraceView() {
+    delete raytracer;
+    delete temporaryDir;
 }
 
 
 void RaytraceView::Update() {
-    m_imageUpTodate = false;
+    if (raytracer != nullptr) UpdateImage();
 
     update();
 }
@@ -71,92 +94,176 @@ void RaytraceView::UpdateTrafo(const QMatrix4x4& transformation) {
 }
 
 
+void RaytraceView::cancel() {
+    if (raytracer == nullptr) return;
+
+    raytracer->cancel();
+    previewTimer.stop();
+    statusLabel->setText("Canceled");
+    cancelButton->setEnabled(false);
+    saveButton->setEnabled(true);
+    update();
+}
+
+
+void RaytraceView::saveImage() {
+    if (raytracer == nullptr) return;
+
+    const QString filePath = QFileDialog::getSaveFileName(this, tr("Save raytraced image"), QString(), "PNG file (*.png)");
+    if (!filePath.isEmpty()) {
+        raytracer->getImage().save(filePath);
+    }
+}
+
+
 void RaytraceView::paintEvent
 (
     QPaintEvent*
 ) {
 
     QPainter painter(this);
-    painter.drawImage(0, 0, m_image);
+    if (raytracer != nullptr) painter.drawImage(0, 0, raytracer->getImage());
 }
 
 
-static void RayTraceCallback
+void RaytraceView::closeEvent
 (
-    const QVector3D&                  direction,
-    QColor&                           color,
-    const BRLCAD::ConstDatabase::Hit& hit
+    QCloseEvent* event
 ) {
-    double    brightness         = 0;
-    double    ambient            = 0.1;
-    double    diffuseWeight      = 0.5;
-    double    specularWeight     = 0.5;
-    int       n                  = 4;
-    QVector3D normal             = QVector3D(hit.SurfaceNormalIn().coordinates[0], hit.SurfaceNormalIn().coordinates[1], hit.SurfaceNormalIn().coordinates[2]);
-    double    dotProduct         = QVector3D::dotProduct(direction, normal); // negative because of opposite directions
+    // nobody looks at the image anymore
+    if (cancelButton->isEnabled()) cancel();
+    QWidget::closeEvent(event);
+}
+
+
+void RaytraceView::UpdateImage() {
+    TRACE_SCOPE("RaytraceView::UpdateImage");
+    // a new camera cancels the image in flight
+    m_imageNumber = raytracer->start(m_imageSize, m_transformation, readShading());
+
+    statusLabel->setText(QString("Pass 1 of %1").arg(raytracer->getPassCount()));
+    cancelButton->setEnabled(true);
+    saveButton->setEnabled(false);
+    previewTimer.start();
+}
+
 
-    // value from 0 to 1
-    double    diffuse            = -dotProduct;
+// the image in flight is for the old camera, a new one is started while the window is open
+void RaytraceView::viewportCameraChanged() {
+    if (raytracer == nullptr || !isVisible()) return;
+    if (document->getViewport()->getW() <= 0 || document->getViewport()->getH() <= 0) return;
+
+    m_imageSize = QSize(document->getViewport()->getW(), document->getViewport()->getH());
+    UpdateTrafo(viewportTransformation());
+}
 
-    // refleced = incidence - 2 normal
-    QVector3D reflectedDir       = direction - 2. * dotProduct * normal;
-    reflectedDir.normalize();
 
-    // value from 0 to 1
-    double    reflectedDotCamDir = std::max(0.f, QVector3D::dotProduct(reflectedDir, direction));
-    double    specular           = pow(reflectedDotCamDir, n);
+// from image pixels to the model coordinates of the active viewport's camera
+QMatrix4x4 RaytraceView::viewportTransformation() const {
+    QMatrix4x4 transformation;
+    transformation.translate(document->getViewport()->getCamera()->getEyePosition().x(),
+                             document->getViewport()->getCamera()->getEyePosition().y(),
+                             document->getViewport()->getCamera()->getEyePosition().z());
+    transformation.rotate(-document->getViewport()->getCamera()->getAnglesAroundAxes().y(), 0., 1., 0.);
+    transformation.rotate(-document->getViewport()->getCamera()->getAnglesAroundAxes().z(), 0., 0., 1.);
+    transformation.rotate(-document->getViewport()->getCamera()->getAnglesAroundAxes().x(), 1., 0., 0.);
+    transformation.translate(0, 0, 10000);
+    transformation.scale(document->getViewport()->getCamera()->getVerticalSpan()/document->getViewport()->getH());
+    transformation.translate(-document->getViewport()->getW()/2.,-document->getViewport()->getH()/2.);
+    return transformation;
+}
 
-    brightness += ambient + diffuse * diffuseWeight;
 
-    double    red                = std::min(hit.Red() * brightness + specular * specularWeight, 1.0);
-    double    green              = std::min(hit.Green() * brightness + specular * specularWeight, 1.0);
-    double    blue               = std::min(hit.Blue() * brightness + specular * specularWeight, 1.0);
+void RaytraceView::reshade() {
+    if (raytracer == nullptr) return;
 
-    color.setRgbF(red, green, blue);
+    raytracer->reshade(readShading());
+    update();
 }
 
 
-void RaytraceView::UpdateImage() {
-    int w  = width();
-    int h = height();
-
-    m_image = QImage(w, h, QImage::Format_RGB32);
-
-    QVector3D directionStart = m_transformation.map(QVector3D(0., 0., 1.));
-    QVector3D directionEnd   = m_transformation.map(QVector3D(0., 0., 0.));
-    QVector3D direction      = directionEnd - directionStart;
-    direction.normalize();
-
-    for (int column = 0; column < w; column++) {
-        for (int row = 0; row < h; row++) {
-            QVector3D     imagePoint(column, h - row - 1., 0.);
-            QVector3D     modelPoint = m_transformation.map(imagePoint);
-            QColor        pixelColor(color);
-            BRLCAD::Ray3D ray;
-
-            ray.origin.coordinates[0]    = modelPoint.x();
-            ray.origin.coordinates[1]    = modelPoint.y();
-            ray.origin.coordinates[2]    = modelPoint.z();
-            ray.direction.coordinates[0] = direction.x();
-            ray.direction.coordinates[1] = direction.y();
-            ray.direction.coordinates[2] = direction.z();
-
-            m_database.ShootRay(ray, [&direction, &pixelColor](const BRLCAD::ConstDatabase::Hit& hit){RayTraceCallback(direction, pixelColor, hit); return false;}, BRLCAD::ConstDatabase::StopAfterFirstHit);
-
-            m_image.setPixelColor(column, row, pixelColor);
-        }
+void RaytraceView::passFinished(quint64 imageNumber, int pass) {
+    // an image canceled meanwhile, or one of a raytracer already replaced
+    if (sender() != raytracer || imageNumber != m_imageNumber) return;
+
+    if (pass + 1 < raytracer->getPassCount()) {
+        const QString nextPass = pass + 1 == TiledRaytracer::ANTIALIASING_PASS ? "Antialiasing, pass %1 of %2"
+                                                                                : "Pass %1 of %2";
+        statusLabel->setText(nextPass.arg(pass + 2).arg(raytracer->getPassCount()));
+    } else {
+        previewTimer.stop();
+        statusLabel->setText("Done");
+        cancelButton->setEnabled(false);
+        saveButton->setEnabled(true);
     }
+    update();
 }
 
 
-void RaytraceView::raytrace() {
-    QSettings settings("BRLCAD", "arbalest");
-    color=settings.value("raytraceBackground").value<QColor>();
+TiledRaytracer::Shading RaytraceView::readShading() {
+    QSettings               settings("BRLCAD", "arbalest");
+    TiledRaytracer::Shading shading;
+
+    QColor color = settings.value("raytraceBackground").value<QColor>();
     bool valid = color.isValid();
     if (!valid) color = Qt::black;
 
-    hide();
+    shading.background     = color.rgb();
+    shading.model          = static_cast<TiledRaytracer::ShadingModel>(settings.value("raytraceShadingModel", shading.model).toInt());
+    shading.ambient        = settings.value("raytraceAmbient", shading.ambient).toFloat();
+    shading.diffuseWeight  = settings.value("raytraceDiffuseWeight", shading.diffuseWeight).toFloat();
+    shading.specularWeight = settings.value("raytraceSpecularWeight", shading.specularWeight).toFloat();
+    shading.shininess      = settings.value("raytraceShininess", shading.shininess).toInt();
+    return shading;
+}
+
+
+bool RaytraceView::createRaytracer() {
+    // the workers load the database from a file, as long as it has not changed since they did they are kept
+    if (raytracer != nullptr && document->getFilePath() != nullptr && !document->isModified() &&
+        m_raytracerDatabasePath == *document->getFilePath() && m_raytracerSelectedPaths == selectedPaths) return true;
+
+    delete raytracer;
+    raytracer = nullptr;
+    delete temporaryDir;
+    temporaryDir = nullptr;
+
+    QString databasePath;
+    if (document->getFilePath() != nullptr && !document->isModified()) {
+        databasePath = *document->getFilePath();
+    } else {
+        // unsaved changes are written to a temporary copy, which has to stay as long as the workers read it
+        temporaryDir = new QTemporaryDir();
+        if (!temporaryDir->isValid()) return false;
+        databasePath = temporaryDir->filePath("raytrace.g");
+        if (!document->SaveCopy(databasePath.toUtf8())) return false;
+    }
+
+    raytracer                = new TiledRaytracer(databasePath, selectedPaths, this);
+    m_raytracerDatabasePath  = databasePath;
+    m_raytracerSelectedPaths = selectedPaths;
+    connect(raytracer, &TiledRaytracer::passFinished, this, &RaytraceView::passFinished);
+    connect(raytracer, &TiledRaytracer::loadFailed, this, [this]() {
+        if (sender() != raytracer) return;
+        previewTimer.stop();
+        statusLabel->setText("Failed");
+        cancelButton->setEnabled(false);
+        // the next raytrace tries to load it again
+        raytracer->deleteLater();
+        raytracer = nullptr;
+        update();
+        QMessageBox::warning(this, "Raytrace", "The database could not be loaded for raytracing.");
+    });
+    return true;
+}
+
+
+void RaytraceView::raytrace() {
+    // nothing to raytrace in a collapsed viewport
+    if (document->getViewport()->getW() <= 0 || document->getViewport()->getH() <= 0) return;
+
     document->getDatabase()->UnSelectAll();
+    selectedPaths.clear();
     document->getObjectTree()->traverseSubTree(0, false, [this]
                                                        (int objectId){
                                                    switch(document->getObjectTree()->getObjectVisibility()[objectId]){
@@ -167,42 +274,24 @@ void RaytraceView::raytrace() {
                                                        case ObjectTree::FullyVisible:
                                                            QString fullPath = document->getObjectTree()->getFullPathMap()[objectId];
                                                            document->getDatabase()->Select(fullPath.toUtf8());
+                                                           selectedPaths.append(fullPath);
                                                            return false;
                                                    }
                                                    return true;
                                                }
     );
 
-    QMatrix4x4 transformation;
-    transformation.translate(document->getViewport()->getCamera()->getEyePosition().x(),
-                             document->getViewport()->getCamera()->getEyePosition().y(),
-                             document->getViewport()->getCamera()->getEyePosition().z());
-    transformation.rotate(-document->getViewport()->getCamera()->getAnglesAroundAxes().y(), 0., 1., 0.);
-    transformation.rotate(-document->getViewport()->getCamera()->getAnglesAroundAxes().z(), 0., 0., 1.);
-    transformation.rotate(-document->getViewport()->getCamera()->getAnglesAroundAxes().x(), 1., 0., 0.);
-    transformation.translate(0, 0, 10000);
-    transformation.scale(document->getViewport()->getCamera()->getVerticalSpan()/document->getViewport()->getH());
-    transformation.translate(-document->getViewport()->getW()/2.,-document->getViewport()->getH()/2.);
+    if (!createRaytracer()) {
+        QMessageBox::warning(this, "Raytrace", "The database could not be written for raytracing.");
+        return;
+    }
 
-    resize(document->getViewport()->getW(),document->getViewport()->getH());
-    UpdateTrafo(transformation);
+    m_imageSize = QSize(document->getViewport()->getW(), document->getViewport()->getH());
+    resize(m_imageSize.width(), m_imageSize.height() + layout()->sizeHint().height());
+    m_transformation = viewportTransformation();
     UpdateImage();
 
-    Update();
     setWindowTitle("Raytrace");
     show();
-
-
-
-    QMessageBox::StandardButton reply;
-    reply = QMessageBox::question(this, "Save?", "Do you want to save the raytraced image?",  QMessageBox::Yes|QMessageBox::No);
-    if (reply == QMessageBox::Yes) {
-        const QString filePath = QFileDialog::getSaveFileName(this, tr("Save raytraced image"), QString(), "PNG file (*.png)");
-        if (!filePath.isEmpty()) {
-            m_image.save(filePath);
-        }
-    } else {
-
-    }
-
+    raise();
 }
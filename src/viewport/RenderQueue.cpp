@@ -0,0 +1,89 @@
+/*                   R E N D E R Q U E U E . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file RenderQueue.cpp */
+
+#include <algorithm>
+#include "RenderQueue.h"
+#include "ViewportManager.h"
+
+
+void RenderQueue::clear() {
+    groups.clear();
+    groupIndices.clear();
+}
+
+void RenderQueue::add(const GeometryCache::Entry *entry, const float color[3], const QMatrix4x4 &matrix) {
+    const GroupKey key{{color[0], color[1], color[2]}, entry->page};
+
+    QHash<GroupKey, int>::const_iterator groupIndex = groupIndices.constFind(key);
+    if (groupIndex == groupIndices.constEnd()) {
+        Group group;
+        group.key = key;
+        groups.append(group);
+        groupIndex = groupIndices.insert(key, groups.size() - 1);
+    }
+
+    Group &group = groups[groupIndex.value()];
+    if (matrix.isIdentity()) {
+        group.entries.append(entry);
+    }
+    else {
+        QHash<const GeometryCache::Entry *, int>::const_iterator placedEntryIndex =
+            group.placedEntryIndices.constFind(entry);
+        if (placedEntryIndex == group.placedEntryIndices.constEnd()) {
+            group.placedEntries.append(PlacedEntry{entry, {}});
+            placedEntryIndex = group.placedEntryIndices.insert(entry, group.placedEntries.size() - 1);
+        }
+        group.placedEntries[placedEntryIndex.value()].placements.append(matrix);
+    }
+}
+
+void RenderQueue::draw(ViewportManager *viewportManager, GeometryCache &geometryCache) {
+    std::sort(groups.begin(), groups.end(), [](const Group &a, const Group &b) {
+        if (a.key.color[0] != b.key.color[0]) return a.key.color[0] < b.key.color[0];
+        if (a.key.color[1] != b.key.color[1]) return a.key.color[1] < b.key.color[1];
+        if (a.key.color[2] != b.key.color[2]) return a.key.color[2] < b.key.color[2];
+        return a.key.page < b.key.page;
+    });
+    // indices are no longer valid after sorting
+    groupIndices.clear();
+
+    drawPass(viewportManager, geometryCache, false);
+    drawPass(viewportManager, geometryCache, true);
+    viewportManager->finishGeometry(geometryCache);
+}
+
+void RenderQueue::drawPass(ViewportManager *viewportManager, GeometryCache &geometryCache, bool surfaces) {
+    for (const Group &group : groups) {
+        viewportManager->setFGColor(group.key.color[0], group.key.color[1], group.key.color[2], 1);
+        if (surfaces) {
+            viewportManager->drawSurfaceGeometry(geometryCache, group.entries);
+            for (const PlacedEntry &placedEntry : group.placedEntries) {
+                viewportManager->drawSurfaceGeometry(geometryCache, placedEntry.entry, placedEntry.placements);
+            }
+        }
+        else {
+            viewportManager->drawWireGeometry(geometryCache, group.entries);
+            for (const PlacedEntry &placedEntry : group.placedEntries) {
+                viewportManager->drawWireGeometry(geometryCache, placedEntry.entry, placedEntry.placements);
+            }
+        }
+    }
+}
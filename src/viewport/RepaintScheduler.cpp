@@ -0,0 +1,65 @@
+/*              R E P A I N T S C H E D U L E R . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file RepaintScheduler.cpp */
+
+#include <algorithm>
+#include <cmath>
+#include <QGuiApplication>
+#include <QScreen>
+#include "RepaintScheduler.h"
+#include "Viewport.h"
+
+// used if the screen does not report its refresh rate
+static const double DEFAULT_REFRESH_RATE = 60.;
+
+
+RepaintScheduler::RepaintScheduler(QObject *parent) : QObject(parent) {
+    flushTimer.setSingleShot(true);
+    flushTimer.setTimerType(Qt::PreciseTimer);
+    connect(&flushTimer, &QTimer::timeout, this, &RepaintScheduler::flush);
+}
+
+void RepaintScheduler::requestRepaint(Viewport *viewport) {
+    if (!pendingViewports.contains(viewport)) pendingViewports.append(viewport);
+    if (flushTimer.isActive()) return;
+
+    // the first request after a quiet period is painted right away, bursts wait for the next refresh
+    int delayMs = 0;
+    if (sinceLastFlush.isValid()) delayMs = std::max<qint64>(0, frameIntervalMs() - sinceLastFlush.elapsed());
+    flushTimer.start(delayMs);
+}
+
+int RepaintScheduler::frameIntervalMs() const {
+    double refreshRate = DEFAULT_REFRESH_RATE;
+    QScreen *screen = QGuiApplication::primaryScreen();
+    if (screen != nullptr && screen->refreshRate() > 0) refreshRate = screen->refreshRate();
+    return static_cast<int>(std::floor(1000. / refreshRate));
+}
+
+void RepaintScheduler::flush() {
+    sinceLastFlush.start();
+    const QVector<QPointer<Viewport>> viewports = pendingViewports;
+    pendingViewports.clear();
+
+    for (const QPointer<Viewport> &viewport : viewports) {
+        if (viewport.isNull() || !viewport->isVisible() || viewport->visibleRegion().isEmpty()) continue;
+        viewport->update();
+    }
+}
@@ -21,6 +21,7 @@
 
 #include "SelectMouseAction.h"
 #include "ViewportGrid.h"
+#include "Trace.h"
 
 
 SelectMouseAction::SelectMouseAction(ViewportGrid* parent, Viewport* watched)
@@ -48,6 +49,7 @@ bool SelectMouseAction::eventFilter(QObject* watched, QEvent* event) {
             QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
 
             if (mouseEvent->button() == Qt::LeftButton) {
+                TRACE_SCOPE("SelectMouseAction::pick");
                 QMatrix4x4 transformation;
                 transformation.translate(m_watched->getCamera()->getEyePosition().x(),
                     m_watched->getCamera()->getEyePosition().y(),
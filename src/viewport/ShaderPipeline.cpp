@@ -0,0 +1,231 @@
+/*                S H A D E R P I P E L I N E . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file ShaderPipeline.cpp */
+
+#include <algorithm>
+#include <iostream>
+#include <QOpenGLContext>
+#include "ShaderPipeline.h"
+
+
+ShaderPipeline::ShaderPipeline() {
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (context->isOpenGLES() || context->format().version() < qMakePair(3, 3)) return;
+    initializeOpenGLFunctions();
+
+    if (!linkProgram(geometryProgram, ":/shaders/geometry.vert", ":/shaders/geometry.frag")) return;
+    if (!linkProgram(gridProgram, ":/shaders/grid.vert", ":/shaders/grid.frag")) return;
+    if (!vertexArrayObject.create()) return;
+
+    litLocation = geometryProgram.uniformLocation("lit");
+    colorLocation = geometryProgram.uniformLocation("color");
+    ambientColorLocation = geometryProgram.uniformLocation("ambientColor");
+    backDiffuseColorLocation = geometryProgram.uniformLocation("backDiffuseColor");
+    placementMatrixLocation = geometryProgram.uniformLocation("placementMatrix");
+    instancedLocation = geometryProgram.uniformLocation("instanced");
+    normalMatrixLocation = geometryProgram.uniformLocation("normalMatrix");
+    compactVerticesLocation = geometryProgram.uniformLocation("compactVertices");
+    gridSpacingLocation = gridProgram.uniformLocation("spacing");
+    gridHalfLengthLocation = gridProgram.uniformLocation("halfLength");
+    gridColorLocation = gridProgram.uniformLocation("color");
+
+    for (const QOpenGLShaderProgram *program : {&geometryProgram, &gridProgram}) {
+        glUniformBlockBinding(program->programId(), glGetUniformBlockIndex(program->programId(), "Camera"),
+                              CAMERA_BINDING);
+    }
+    glGenBuffers(1, &cameraBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, 2 * 16 * sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glGenBuffers(1, &instanceBuffer);
+
+    valid = true;
+}
+
+ShaderPipeline::~ShaderPipeline() {
+    if (cameraBuffer != 0) glDeleteBuffers(1, &cameraBuffer);
+    if (instanceBuffer != 0) glDeleteBuffers(1, &instanceBuffer);
+}
+
+bool ShaderPipeline::linkProgram(QOpenGLShaderProgram &program, const QString &vertexShader,
+                                 const QString &fragmentShader) {
+    if (!program.addShaderFromSourceFile(QOpenGLShader::Vertex, vertexShader) ||
+        !program.addShaderFromSourceFile(QOpenGLShader::Fragment, fragmentShader) ||
+        !program.link()) {
+        std::cerr << "ShaderPipeline: " << program.log().toStdString() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ShaderPipeline::setCamera(const QMatrix4x4 &modelView, const QMatrix4x4 &projection) {
+    if (!valid) return;
+
+    // QMatrix4x4 stores column major, which is what std140 expects for mat4
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, 16 * sizeof(GLfloat), modelView.constData());
+    glBufferSubData(GL_UNIFORM_BUFFER, 16 * sizeof(GLfloat), 16 * sizeof(GLfloat), projection.constData());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    this->modelView = modelView;
+    placementUniformsOutdated = true;
+}
+
+void ShaderPipeline::setPlacementMatrix(const QMatrix4x4 &placementMatrix) {
+    if (placementMatrix == this->placementMatrix) return;
+    this->placementMatrix = placementMatrix;
+    placementUniformsOutdated = true;
+}
+
+void ShaderPipeline::bind() {
+    if (!bound) {
+        geometryProgram.bind();
+        vertexArrayObject.bind();
+        glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, cameraBuffer);
+        bound = true;
+    }
+    if (placementUniformsOutdated) {
+        geometryProgram.setUniformValue(placementMatrixLocation, placementMatrix);
+        geometryProgram.setUniformValue(normalMatrixLocation, (modelView * placementMatrix).normalMatrix());
+        placementUniformsOutdated = false;
+    }
+}
+
+void ShaderPipeline::drawWires(GeometryCache &geometryCache, const QVector<const GeometryCache::Entry *> &entries,
+                               const float wireColor[4]) {
+    if (entries.isEmpty()) return;
+
+    bind();
+    setWireUniforms(wireColor);
+    bindPage(geometryCache, *entries.first());
+    geometryCache.draw(GeometryData::Lines, entries);
+    geometryCache.draw(GeometryData::Points, entries);
+}
+
+void ShaderPipeline::drawSurfaces(GeometryCache &geometryCache, const QVector<const GeometryCache::Entry *> &entries,
+                                  const float diffuseColor[4], const float ambientColor[4],
+                                  const float backDiffuseColor[4]) {
+    if (entries.isEmpty()) return;
+
+    bind();
+    setSurfaceUniforms(diffuseColor, ambientColor, backDiffuseColor);
+    bindPage(geometryCache, *entries.first());
+    geometryCache.draw(GeometryData::Triangles, entries);
+}
+
+void ShaderPipeline::drawWires(GeometryCache &geometryCache, const GeometryCache::Entry &entry,
+                               const QVector<QMatrix4x4> &placements, const float wireColor[4]) {
+    if (placements.isEmpty()) return;
+
+    bind();
+    setWireUniforms(wireColor);
+    bindPage(geometryCache, entry);
+    bindInstances(placements);
+    geometryCache.drawInstanced(GeometryData::Lines, entry, placements.size());
+    geometryCache.drawInstanced(GeometryData::Points, entry, placements.size());
+    releaseInstances();
+}
+
+void ShaderPipeline::drawSurfaces(GeometryCache &geometryCache, const GeometryCache::Entry &entry,
+                                  const QVector<QMatrix4x4> &placements, const float diffuseColor[4],
+                                  const float ambientColor[4], const float backDiffuseColor[4]) {
+    if (placements.isEmpty()) return;
+
+    bind();
+    setSurfaceUniforms(diffuseColor, ambientColor, backDiffuseColor);
+    bindPage(geometryCache, entry);
+    bindInstances(placements);
+    geometryCache.drawInstanced(GeometryData::Triangles, entry, placements.size());
+    releaseInstances();
+}
+
+void ShaderPipeline::setWireUniforms(const float wireColor[4]) {
+    geometryProgram.setUniformValue(litLocation, 0);
+    glUniform4fv(colorLocation, 1, wireColor);
+}
+
+void ShaderPipeline::setSurfaceUniforms(const float diffuseColor[4], const float ambientColor[4],
+                                        const float backDiffuseColor[4]) {
+    geometryProgram.setUniformValue(litLocation, 1);
+    glUniform4fv(colorLocation, 1, diffuseColor);
+    glUniform4fv(ambientColorLocation, 1, ambientColor);
+    glUniform4fv(backDiffuseColorLocation, 1, backDiffuseColor);
+}
+
+// entries drawn together live in the same page and so share its vertex format
+void ShaderPipeline::bindPage(GeometryCache &geometryCache, const GeometryCache::Entry &entry) {
+    const bool compactVertices = entry.vertexFormat == GeometryCache::CompactVertices;
+    geometryProgram.setUniformValue(compactVerticesLocation, compactVertices ? 1 : 0);
+    geometryCache.bindPage(entry.page, GeometryCache::ShaderAttributes);
+}
+
+/*
+ * Streams the placements to the instance buffer and feeds them to the vertex shader, one matrix per instance.
+ * The page's vertex attributes are kept by the vertex array object, so rebinding the array buffer does not
+ * disturb them.
+ */
+void ShaderPipeline::bindInstances(const QVector<QMatrix4x4> &placements) {
+    // QMatrix4x4 carries flags besides its column major values, so the values are packed first
+    QVector<GLfloat> values(placements.size() * 16);
+    for (int i = 0; i < placements.size(); i++) {
+        std::copy(placements[i].constData(), placements[i].constData() + 16, values.data() + i * 16);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    // orphans the storage of the previous draw instead of waiting for it
+    glBufferData(GL_ARRAY_BUFFER, values.size() * sizeof(GLfloat), values.constData(), GL_STREAM_DRAW);
+
+    for (GLuint column = 0; column < 4; column++) {
+        const GLuint location = INSTANCE_PLACEMENT_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat),
+                              reinterpret_cast<const void *>(column * 4 * sizeof(GLfloat)));
+        glVertexAttribDivisor(location, 1);
+    }
+    geometryProgram.setUniformValue(instancedLocation, 1);
+}
+
+void ShaderPipeline::releaseInstances() {
+    for (GLuint column = 0; column < 4; column++) glDisableVertexAttribArray(INSTANCE_PLACEMENT_LOCATION + column);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    geometryProgram.setUniformValue(instancedLocation, 0);
+}
+
+void ShaderPipeline::release(GeometryCache &geometryCache) {
+    geometryCache.unbind();
+    if (!bound) return;
+
+    vertexArrayObject.release();
+    geometryProgram.release();
+    bound = false;
+}
+
+void ShaderPipeline::drawGrid(float spacing, float halfLength, const float color[4]) {
+    gridProgram.bind();
+    vertexArrayObject.bind();
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, cameraBuffer);
+    glUniform1f(gridSpacingLocation, spacing);
+    glUniform1f(gridHalfLengthLocation, halfLength);
+    glUniform4fv(gridColorLocation, 1, color);
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    vertexArrayObject.release();
+    gridProgram.release();
+}
@@ -0,0 +1,323 @@
+/*             T E S S E L L A T I O N C A C H E . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file TessellationCache.cpp */
+
+#include <cstring>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include "TessellationCache.h"
+
+static const quint32 CACHE_FILE_MAGIC = 0x41544331;
+
+// db5 object header, see BRL-CAD's db5.h
+static const uchar DB5_MAGIC1 = 0x76;
+static const uchar DB5_MAGIC2 = 0x35;
+static const uchar DB5_HFLAGS_NAME_PRESENT = 0x20;
+static const int DB5_HFLAGS_INTERIOR_SHIFT = 3;
+static const int DB5_HFLAGS_OBJECT_WIDTH_SHIFT = 6;
+static const int DB5_MINIMUM_OBJECT_SIZE = 8;
+
+
+static quint64 readBigEndian(const uchar *data, int width) {
+    quint64 value = 0;
+    for (int i = 0; i < width; i++) value = (value << 8) | data[i];
+    return value;
+}
+
+TessellationCache::TessellationCache(const QString &databasePath) : databasePath(databasePath) {}
+
+void TessellationCache::load() {
+    QSettings settings("BRLCAD", "arbalest");
+    if (!settings.value("tessellationCache", true).toBool()) return;
+
+    const QByteArray pathHash = QCryptographicHash::hash(QFileInfo(databasePath).absoluteFilePath().toUtf8(),
+                                                         QCryptographicHash::Md5).toHex();
+    cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/tessellation/" +
+                QString::fromLatin1(pathHash) + ".cache";
+
+    // without the records there is nothing to validate entries against
+    if (!readDatabaseKeys()) return;
+    mapCacheFile();
+    enabled = true;
+}
+
+bool TessellationCache::find(const QString &objectName, QVector<GeometryData> &levelsOfDetail) const {
+    if (!enabled) return false;
+    QHash<QString, QByteArray>::const_iterator objectKey = objectKeys.constFind(objectName);
+    if (objectKey == objectKeys.constEnd()) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(insertedMutex);
+        QHash<QString, InsertedEntry>::const_iterator inserted = insertedEntries.constFind(objectName);
+        if (inserted != insertedEntries.constEnd() && inserted->key == *objectKey) {
+            return deserialize(reinterpret_cast<const uchar *>(inserted->data.constData()), inserted->data.size(),
+                               levelsOfDetail);
+        }
+    }
+
+    QHash<QString, MappedEntry>::const_iterator mapped = mappedEntries.constFind(objectName);
+    if (mapped == mappedEntries.constEnd() || mapped->key != *objectKey) return false;
+    return deserialize(mappedData + mapped->offset, mapped->size, levelsOfDetail);
+}
+
+void TessellationCache::insert(const QString &objectName, const QVector<GeometryData> &levelsOfDetail) {
+    if (!enabled) return;
+    QHash<QString, QByteArray>::const_iterator objectKey = objectKeys.constFind(objectName);
+    if (objectKey == objectKeys.constEnd()) return;
+
+    InsertedEntry entry{*objectKey, serialize(levelsOfDetail)};
+    std::lock_guard<std::mutex> lock(insertedMutex);
+    insertedEntries.insert(objectName, entry);
+}
+
+void TessellationCache::save() {
+    if (!enabled || insertedEntries.isEmpty()) return;
+
+    struct WrittenEntry {
+        QString objectName;
+        QByteArray key;
+        const char *data;
+        qint64 size;
+    };
+    QVector<WrittenEntry> writtenEntries;
+    for (QHash<QString, InsertedEntry>::const_iterator it = insertedEntries.constBegin();
+         it != insertedEntries.constEnd(); ++it) {
+        writtenEntries.append({it.key(), it->key, it->data.constData(), it->data.size()});
+    }
+    // objects that were not drawn this time are kept, objects that changed or are gone are dropped
+    for (QHash<QString, MappedEntry>::const_iterator it = mappedEntries.constBegin();
+         it != mappedEntries.constEnd(); ++it) {
+        if (insertedEntries.contains(it.key()) || objectKeys.value(it.key()) != it->key) continue;
+        writtenEntries.append({it.key(), it->key, reinterpret_cast<const char *>(mappedData + it->offset),
+                               it->size});
+    }
+
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << CACHE_FILE_MAGIC << FORMAT_VERSION << static_cast<quint32>(writtenEntries.size());
+    qint64 offset = 0;
+    for (const WrittenEntry &entry : writtenEntries) {
+        stream << entry.objectName << entry.key << offset << entry.size;
+        offset += entry.size;
+    }
+    for (const WrittenEntry &entry : writtenEntries) file.write(entry.data, entry.size);
+
+    // the old file cannot be replaced while it is mapped on every platform
+    mappedEntries.clear();
+    if (mappedData != nullptr) cacheFile.unmap(const_cast<uchar *>(mappedData));
+    mappedData = nullptr;
+    cacheFile.close();
+    file.commit();
+}
+
+/*
+ * Walks the db5 object headers of the database file and hashes the complete record of every named object.
+ * Returns false if the file is not a db5 database or looks damaged.
+ */
+bool TessellationCache::readDatabaseKeys() {
+    QFile databaseFile(databasePath);
+    if (!databaseFile.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = databaseFile.size();
+    const uchar *data = databaseFile.map(0, size);
+    if (data == nullptr) return false;
+
+    const QByteArray parameters = GeometryData::levelOfDetailParameters();
+    bool valid = size >= DB5_MINIMUM_OBJECT_SIZE;
+    qint64 position = 0;
+    while (valid && position < size) {
+        const uchar *record = data + position;
+        const qint64 remaining = size - position;
+        if (remaining < DB5_MINIMUM_OBJECT_SIZE || record[0] != DB5_MAGIC1) {
+            valid = false;
+            break;
+        }
+
+        const uchar headerFlags = record[1];
+        const int objectWidth = 1 << (headerFlags >> DB5_HFLAGS_OBJECT_WIDTH_SHIFT);
+        const int interiorWidth = 1 << ((headerFlags >> DB5_HFLAGS_INTERIOR_SHIFT) & 0x03);
+        if (4 + objectWidth > remaining) {
+            valid = false;
+            break;
+        }
+        // the length is counted in 8 byte chunks
+        const quint64 length = readBigEndian(record + 4, objectWidth) << 3;
+        if (length < DB5_MINIMUM_OBJECT_SIZE || length > static_cast<quint64>(remaining) ||
+            record[length - 1] != DB5_MAGIC2) {
+            valid = false;
+            break;
+        }
+
+        if (headerFlags & DB5_HFLAGS_NAME_PRESENT) {
+            const qint64 nameOffset = 4 + objectWidth + interiorWidth;
+            if (nameOffset > static_cast<qint64>(length)) {
+                valid = false;
+                break;
+            }
+            // includes the terminating null
+            const quint64 nameLength = readBigEndian(record + 4 + objectWidth, interiorWidth);
+            if (nameLength < 1 || nameOffset + nameLength > length) {
+                valid = false;
+                break;
+            }
+            const QString objectName = QString::fromUtf8(reinterpret_cast<const char *>(record + nameOffset),
+                                                         static_cast<qsizetype>(nameLength - 1));
+
+            QCryptographicHash hash(QCryptographicHash::Md5);
+            hash.addData(QByteArray::fromRawData(reinterpret_cast<const char *>(record),
+                                                 static_cast<qsizetype>(length)));
+            hash.addData(parameters);
+            objectKeys.insert(objectName, hash.result());
+        }
+        position += length;
+    }
+
+    databaseFile.unmap(const_cast<uchar *>(data));
+    if (!valid) objectKeys.clear();
+    return valid;
+}
+
+bool TessellationCache::mapCacheFile() {
+    cacheFile.setFileName(cachePath);
+    if (!cacheFile.exists() || !cacheFile.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = cacheFile.size();
+    const uchar *data = cacheFile.map(0, size);
+    if (data == nullptr) {
+        cacheFile.close();
+        return false;
+    }
+
+    const QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(data), size);
+    QDataStream stream(bytes);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 entryCount = 0;
+    stream >> magic >> version >> entryCount;
+
+    bool valid = stream.status() == QDataStream::Ok && magic == CACHE_FILE_MAGIC && version == FORMAT_VERSION;
+    for (quint32 i = 0; valid && i < entryCount; i++) {
+        QString objectName;
+        MappedEntry entry;
+        stream >> objectName >> entry.key >> entry.offset >> entry.size;
+        valid = stream.status() == QDataStream::Ok;
+        if (valid) mappedEntries.insert(objectName, entry);
+    }
+
+    // offsets are relative to the end of the index
+    const qint64 dataStart = stream.device()->pos();
+    for (QHash<QString, MappedEntry>::iterator it = mappedEntries.begin(); valid && it != mappedEntries.end(); ++it) {
+        it->offset += dataStart;
+        valid = it->offset >= dataStart && it->size >= 0 && it->offset + it->size <= size;
+    }
+
+    if (!valid) {
+        mappedEntries.clear();
+        cacheFile.unmap(const_cast<uchar *>(data));
+        cacheFile.close();
+        return false;
+    }
+    mappedData = data;
+    return true;
+}
+
+/*
+ * Per level: cluster cell size, vertex float count, index counts per primitive, vertices, indices per primitive.
+ * Native byte order, the cache never leaves the machine.
+ */
+QByteArray TessellationCache::serialize(const QVector<GeometryData> &levelsOfDetail) {
+    QByteArray data;
+    const qint32 levelCount = levelsOfDetail.size();
+    data.append(reinterpret_cast<const char *>(&levelCount), sizeof(levelCount));
+    for (const GeometryData &level : levelsOfDetail) {
+        data.append(reinterpret_cast<const char *>(&level.clusterCellSize), sizeof(level.clusterCellSize));
+        const qint32 vertexFloatCount = level.vertices.size();
+        data.append(reinterpret_cast<const char *>(&vertexFloatCount), sizeof(vertexFloatCount));
+        for (const QVector<GLuint> &primitiveIndices : level.indices) {
+            const qint32 indexCount = primitiveIndices.size();
+            data.append(reinterpret_cast<const char *>(&indexCount), sizeof(indexCount));
+        }
+        data.append(reinterpret_cast<const char *>(level.vertices.constData()), vertexFloatCount * sizeof(GLfloat));
+        for (const QVector<GLuint> &primitiveIndices : level.indices) {
+            data.append(reinterpret_cast<const char *>(primitiveIndices.constData()),
+                        primitiveIndices.size() * sizeof(GLuint));
+        }
+    }
+    return data;
+}
+
+bool TessellationCache::deserialize(const uchar *data, qint64 size, QVector<GeometryData> &levelsOfDetail) {
+    qint64 position = 0;
+    auto read = [&](void *target, qint64 bytes) {
+        if (bytes < 0 || position + bytes > size) return false;
+        std::memcpy(target, data + position, bytes);
+        position += bytes;
+        return true;
+    };
+
+    qint32 levelCount = 0;
+    if (!read(&levelCount, sizeof(levelCount)) || levelCount < 1 || levelCount > GeometryData::MAX_LEVELS_OF_DETAIL) {
+        return false;
+    }
+
+    QVector<GeometryData> levels(levelCount);
+    for (GeometryData &level : levels) {
+        qint32 vertexFloatCount = 0;
+        qint32 indexCounts[GeometryData::PrimitiveCount];
+        if (!read(&level.clusterCellSize, sizeof(level.clusterCellSize)) ||
+            !read(&vertexFloatCount, sizeof(vertexFloatCount)) ||
+            !read(indexCounts, sizeof(indexCounts)) ||
+            vertexFloatCount < 0 || vertexFloatCount % GeometryData::FLOATS_PER_VERTEX != 0) {
+            return false;
+        }
+        // the counts of a damaged entry must not allocate more than its bytes can hold
+        qint64 levelBytes = vertexFloatCount * static_cast<qint64>(sizeof(GLfloat));
+        for (qint32 indexCount : indexCounts) {
+            if (indexCount < 0) return false;
+            levelBytes += indexCount * static_cast<qint64>(sizeof(GLuint));
+        }
+        if (levelBytes > size - position) return false;
+        const GLuint vertexCount = vertexFloatCount / GeometryData::FLOATS_PER_VERTEX;
+
+        level.vertices.resize(vertexFloatCount);
+        if (!read(level.vertices.data(), vertexFloatCount * static_cast<qint64>(sizeof(GLfloat)))) return false;
+        for (int primitive = 0; primitive < GeometryData::PrimitiveCount; primitive++) {
+            level.indices[primitive].resize(indexCounts[primitive]);
+            if (!read(level.indices[primitive].data(), indexCounts[primitive] * static_cast<qint64>(sizeof(GLuint)))) {
+                return false;
+            }
+            // an index past the vertices would make the draw read outside the buffer
+            for (GLuint index : level.indices[primitive]) {
+                if (index >= vertexCount) return false;
+            }
+        }
+    }
+
+    levelsOfDetail = levels;
+    return true;
+}
@@ -0,0 +1,128 @@
+/*              T E S S E L L A T I O N P O O L . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file TessellationPool.cpp */
+
+#include <algorithm>
+#include <QSettings>
+#include <QThreadPool>
+#include <QThread>
+#include <brlcad/Database/ConstDatabase.h>
+#include "TessellationPool.h"
+#include "Trace.h"
+
+
+TessellationPool::TessellationPool(const QString &databasePath, QObject *parent) :
+    QObject(parent), databasePath(databasePath.toUtf8()),
+    cache(std::make_shared<TessellationCache>(databasePath)) {
+    // every worker holds its own copy of the database, so the default stays small for big files
+    QSettings settings("BRLCAD", "arbalest");
+    const int defaultWorkerCount = std::clamp(QThread::idealThreadCount() - 1, 1, MAX_DEFAULT_WORKERS);
+    const int workerCount = std::max(1, settings.value("tessellationThreads", defaultWorkerCount).toInt());
+
+    for (int i = 0; i < workerCount; i++) workers.emplace_back(&TessellationPool::work, this);
+}
+
+TessellationPool::~TessellationPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    condition.notify_all();
+    for (std::thread &worker : workers) worker.join();
+
+    std::shared_ptr<TessellationCache> cache = this->cache;
+    QThreadPool::globalInstance()->start([cache]() {
+        TRACE_SCOPE("TessellationCache::save");
+        cache->save();
+    });
+}
+
+void TessellationPool::enqueue(const QString &objectName) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(objectName);
+    }
+    condition.notify_one();
+}
+
+QStringList TessellationPool::cancelQueued() {
+    QStringList canceledObjectNames;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const QString &objectName : jobs) canceledObjectNames.append(objectName);
+    jobs.clear();
+    return canceledObjectNames;
+}
+
+std::vector<TessellationPool::Result> TessellationPool::takeResults() {
+    std::vector<Result> taken;
+    std::lock_guard<std::mutex> lock(mutex);
+    taken.swap(results);
+    return taken;
+}
+
+void TessellationPool::work() {
+    BRLCAD::ConstDatabase database;
+    bool loadTried = false;
+    bool loaded = false;
+    Trace::setThreadName("TessellationPool worker");
+    // the first worker reads the cache while the others wait for it
+    std::call_once(cacheLoaded, [this]() { cache->load(); });
+
+    while (true) {
+        QString objectName;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            objectName = jobs.front();
+            jobs.pop_front();
+        }
+
+        TRACE_SCOPE("TessellationPool::tessellate");
+        Result result{objectName, true, QVector<GeometryData>()};
+        if (!cache->find(objectName, result.levelsOfDetail)) {
+            // the database is opened on first use so idle workers and cached objects cost no memory
+            if (!loadTried) {
+                loaded = database.Load(databasePath.constData());
+                loadTried = true;
+            }
+
+            result.plotted = loaded;
+            if (loaded) {
+                BRLCAD::VectorList vectorList;
+                database.Plot(objectName.toUtf8().constData(), vectorList);
+                GeometryData geometryData;
+                geometryData.appendVectorList(vectorList);
+                result.levelsOfDetail = geometryData.levelsOfDetail();
+                cache->insert(objectName, result.levelsOfDetail);
+            }
+        }
+
+        bool firstResult;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return;
+            results.push_back(std::move(result));
+            firstResult = results.size() == 1;
+        }
+        if (firstResult) emit resultsReady();
+    }
+}
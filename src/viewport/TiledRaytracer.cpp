@@ -0,0 +1,565 @@
+/*                T I L E D R A Y T R A C E R . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file TiledRaytracer.cpp */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QSettings>
+#include <QThread>
+#include "TiledRaytracer.h"
+#include "Trace.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TILEDRAYTRACER_SSE2
+#endif
+
+namespace {
+    // rays are shot at the top left pixel of every block; each size has to divide the previous one and TILE_SIZE
+    const int passBlockSizes[TiledRaytracer::TRACING_PASS_COUNT] = {16, 4, 1};
+
+    // rotated grid around the pixel's ray, in pixels
+    const float subsampleOffsets[][2] = {{-.125f, -.375f}, {.375f, -.125f}, {-.375f, .125f}, {.125f, .375f}};
+    // neighbors at more than this depth difference, or normals at a larger angle, make an edge
+    const float edgeDepthInPixels = 4.f;
+    const float edgeNormalCosine = .9f;
+
+    int colorByte(float value) {
+        return static_cast<int>(std::clamp(value, 0.f, 1.f) * 255.f + .5f);
+    }
+
+    // one pixel of TiledRaytracer::shadeSpan(), the same computation as its SSE2 part
+    QRgb shadePixel(const TiledRaytracer::Shading &shading, const QVector3D &direction, const QVector3D &normal,
+                    const QVector3D &baseColor) {
+        if (shading.model == TiledRaytracer::NormalShading) {
+            const QVector3D color = (normal + QVector3D(1.f, 1.f, 1.f)) * .5f;
+            return qRgb(colorByte(color.x()), colorByte(color.y()), colorByte(color.z()));
+        }
+
+        // negative because of opposite directions
+        const float dotProduct = QVector3D::dotProduct(direction, normal);
+        const float brightness = shading.ambient - dotProduct * shading.diffuseWeight;
+        float       specular   = 0.f;
+
+        if (shading.model == TiledRaytracer::PhongShading) {
+            // reflected = incidence - 2 normal
+            const QVector3D reflected          = direction - 2.f * dotProduct * normal;
+            const float     reflectedDotCamDir = std::max(0.f, QVector3D::dotProduct(reflected, direction) /
+                                                               std::max(reflected.length(), 1e-12f));
+
+            float power = 1.f;
+            float base  = reflectedDotCamDir;
+            for (int exponent = shading.shininess; exponent > 0; exponent >>= 1) {
+                if (exponent & 1) power *= base;
+                base *= base;
+            }
+            specular = power * shading.specularWeight;
+        }
+
+        return qRgb(colorByte(baseColor.x() * brightness + specular), colorByte(baseColor.y() * brightness + specular),
+                    colorByte(baseColor.z() * brightness + specular));
+    }
+}
+
+
+TiledRaytracer::TiledRaytracer(const QString &databasePath, const QStringList &selectedPaths, QObject *parent) :
+    QObject(parent), databasePath(databasePath.toUtf8()), selectedPaths(selectedPaths), currentFrame() {
+    QSettings settings("BRLCAD", "arbalest");
+    passCount = settings.value("raytraceAntialiasing", true).toBool() ? ANTIALIASING_PASS + 1 : TRACING_PASS_COUNT;
+    const int workerCount = std::max(1, settings.value("raytraceThreads", QThread::idealThreadCount()).toInt());
+
+    queues.resize(workerCount);
+    for (int i = 0; i < workerCount; i++) workers.emplace_back(&TiledRaytracer::work, this, i);
+}
+
+TiledRaytracer::~TiledRaytracer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        imageNumber++;
+        clearQueues();
+    }
+    tilesQueued.notify_all();
+    for (std::thread &worker : workers) worker.join();
+}
+
+quint64 TiledRaytracer::start(const QSize &size, const QMatrix4x4 &transformation, const Shading &shading) {
+    TRACE_SCOPE("TiledRaytracer::start");
+    std::unique_lock<std::mutex> lock(mutex);
+    const quint64 startedImageNumber = ++imageNumber;
+    clearQueues();
+    // the workers check the image number once per row, so this waits for one row of rays at most
+    tileStopped.wait(lock, [this]() { return runningTileCount == 0; });
+
+    if (image.size() != size) {
+        image = QImage(size, QImage::Format_RGB32);
+        image.fill(shading.background);
+
+        const size_t pixelCount = static_cast<size_t>(size.width()) * size.height();
+        for (std::vector<float> *channel : {&gBuffer.depths, &gBuffer.normalX, &gBuffer.normalY, &gBuffer.normalZ,
+                                            &gBuffer.red, &gBuffer.green, &gBuffer.blue}) {
+            channel->resize(pixelCount);
+        }
+    }
+    // until they are traced, pixels show the background when reshaded
+    gBuffer.regionIds.assign(static_cast<size_t>(size.width()) * size.height(), -1);
+
+    QVector3D directionStart = transformation.map(QVector3D(0., 0., 1.));
+    QVector3D directionEnd   = transformation.map(QVector3D(0., 0., 0.));
+    QVector3D direction      = directionEnd - directionStart;
+    direction.normalize();
+
+    // bits() detaches the image, which must not happen on the workers
+    const float pixelSize = (transformation.map(QVector3D(1., 0., 0.)) - directionEnd).length();
+    currentFrame = {image.bits(), image.bytesPerLine(), image.width(), image.height(), transformation, direction,
+                    pixelSize, shading};
+
+    tiles.clear();
+    for (int y = 0; y < image.height(); y += TILE_SIZE) {
+        for (int x = 0; x < image.width(); x += TILE_SIZE) {
+            tiles.push_back({x, y, std::min(TILE_SIZE, image.width() - x), std::min(TILE_SIZE, image.height() - y), 0,
+                             startedImageNumber, static_cast<int>(tiles.size())});
+        }
+    }
+    tileSubsamples.assign(tiles.size(), Subsamples());
+
+    if (tiles.empty()) {
+        // queued, so the caller knows the image number before the signal arrives
+        const int lastPass = passCount - 1;
+        QMetaObject::invokeMethod(this, [this, startedImageNumber, lastPass]() {
+            emit passFinished(startedImageNumber, lastPass);
+        }, Qt::QueuedConnection);
+        return startedImageNumber;
+    }
+
+    queuePass(0);
+    lock.unlock();
+    tilesQueued.notify_all();
+    return startedImageNumber;
+}
+
+void TiledRaytracer::cancel() {
+    std::unique_lock<std::mutex> lock(mutex);
+    imageNumber++;
+    clearQueues();
+    tileStopped.wait(lock, [this]() { return runningTileCount == 0; });
+}
+
+void TiledRaytracer::reshade(const Shading &shading) {
+    TRACE_SCOPE("TiledRaytracer::reshade");
+    std::unique_lock<std::mutex> lock(mutex);
+    currentFrame.shading = shading;
+    if (image.isNull()) return;
+
+    // tiles in flight still use the old shading, so they are waited for; this takes one tile at most
+    paused = true;
+    tileStopped.wait(lock, [this]() { return runningTileCount == 0; });
+
+    for (int row = 0; row < image.height(); row++) {
+        QRgb *scanline = reinterpret_cast<QRgb *>(currentFrame.bits + row * currentFrame.bytesPerLine);
+        shadeSpan(shading, currentFrame.direction, gBuffer, static_cast<size_t>(row) * image.width(), image.width(),
+                  scanline);
+    }
+    for (const Subsamples &subsamples : tileSubsamples) shadeSubsamples(currentFrame, subsamples);
+
+    paused = false;
+    lock.unlock();
+    tilesQueued.notify_all();
+}
+
+QString TiledRaytracer::getRegionName(int regionId) const {
+    std::lock_guard<std::mutex> lock(regionMutex);
+    return regionId >= 0 && regionId < regionNames.size() ? regionNames[regionId] : QString();
+}
+
+void TiledRaytracer::work(int workerIndex) {
+    Trace::setThreadName(QString("TiledRaytracer worker %1").arg(workerIndex));
+
+    BRLCAD::ConstDatabase database;
+    QHash<QString, int> knownRegionIds;
+    bool loaded;
+    {
+        TRACE_SCOPE("TiledRaytracer::load");
+        loaded = database.Load(databasePath.constData());
+        if (loaded) {
+            database.UnSelectAll();
+            for (const QString &fullPath : selectedPaths) database.Select(fullPath.toUtf8().constData());
+        }
+    }
+
+    if (!loaded) {
+        // the tiles dealt to this worker are stolen by the others
+        bool allFailed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            allFailed = ++failedWorkerCount == static_cast<int>(queues.size());
+        }
+        if (allFailed) emit loadFailed();
+        return;
+    }
+
+    while (true) {
+        Tile tile;
+        Frame tileFrame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            tilesQueued.wait(lock, [this]() { return stopping || (!paused && queuedTileCount > 0); });
+            if (stopping) return;
+            takeTile(workerIndex, tile);
+            tileFrame = currentFrame;
+            runningTileCount++;
+        }
+
+        if (tile.pass == ANTIALIASING_PASS) {
+            antialiasTile(database, knownRegionIds, tileFrame, tile);
+        } else {
+            traceTile(database, knownRegionIds, tileFrame, tile);
+        }
+
+        bool passDone = false;
+        bool nextPassQueued = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            runningTileCount--;
+            if (tile.imageNumber == imageNumber && --remainingTileCount == 0) {
+                passDone = true;
+                if (tile.pass + 1 < passCount) {
+                    queuePass(tile.pass + 1);
+                    nextPassQueued = true;
+                }
+            }
+        }
+        tileStopped.notify_all();
+        if (nextPassQueued) tilesQueued.notify_all();
+        if (passDone) emit passFinished(tile.imageNumber, tile.pass);
+    }
+}
+
+void TiledRaytracer::queuePass(int pass) {
+    const quint64 currentImageNumber = imageNumber;
+    for (size_t i = 0; i < tiles.size(); i++) {
+        Tile tile = tiles[i];
+        tile.pass = pass;
+        tile.imageNumber = currentImageNumber;
+        queues[i % queues.size()].push_back(tile);
+    }
+    queuedTileCount = static_cast<int>(tiles.size());
+    remainingTileCount = queuedTileCount;
+}
+
+void TiledRaytracer::clearQueues() {
+    for (std::deque<Tile> &queue : queues) queue.clear();
+    queuedTileCount = 0;
+    remainingTileCount = 0;
+}
+
+bool TiledRaytracer::takeTile(int workerIndex, Tile &tile) {
+    std::deque<Tile> &ownQueue = queues[workerIndex];
+    if (!ownQueue.empty()) {
+        tile = ownQueue.front();
+        ownQueue.pop_front();
+        queuedTileCount--;
+        return true;
+    }
+
+    for (size_t i = 1; i < queues.size(); i++) {
+        std::deque<Tile> &victimQueue = queues[(workerIndex + i) % queues.size()];
+        if (!victimQueue.empty()) {
+            tile = victimQueue.back();
+            victimQueue.pop_back();
+            queuedTileCount--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TiledRaytracer::traceTile(BRLCAD::ConstDatabase &database, QHash<QString, int> &knownRegionIds,
+                               const Frame &frame, const Tile &tile) {
+    TRACE_SCOPE("TiledRaytracer::traceTile");
+    const int blockSize = passBlockSizes[tile.pass];
+    const int tracedBlockSize = tile.pass > 0 ? passBlockSizes[tile.pass - 1] : 0;
+
+    for (int row = tile.y; row < tile.y + tile.height; row += blockSize) {
+        if (tile.imageNumber != imageNumber.load(std::memory_order_relaxed)) return;
+        const int blockHeight = std::min(blockSize, tile.y + tile.height - row);
+
+        for (int column = tile.x; column < tile.x + tile.width; column += blockSize) {
+            // shot in a coarser pass already
+            if (tracedBlockSize > 0 && row % tracedBlockSize == 0 && column % tracedBlockSize == 0) continue;
+
+            const Sample sample = trace(database, knownRegionIds, frame, column, row);
+
+            // the sample fills its block, so the whole tile can be shaded at once
+            const int blockWidth = std::min(blockSize, tile.x + tile.width - column);
+            for (int blockRow = row; blockRow < row + blockHeight; blockRow++) {
+                const size_t first = static_cast<size_t>(blockRow) * frame.width + column;
+                std::fill_n(gBuffer.regionIds.begin() + first, blockWidth, sample.regionId);
+                std::fill_n(gBuffer.depths.begin() + first, blockWidth, sample.depth);
+                std::fill_n(gBuffer.normalX.begin() + first, blockWidth, sample.normal.x());
+                std::fill_n(gBuffer.normalY.begin() + first, blockWidth, sample.normal.y());
+                std::fill_n(gBuffer.normalZ.begin() + first, blockWidth, sample.normal.z());
+                std::fill_n(gBuffer.red.begin() + first, blockWidth, sample.baseColor.x());
+                std::fill_n(gBuffer.green.begin() + first, blockWidth, sample.baseColor.y());
+                std::fill_n(gBuffer.blue.begin() + first, blockWidth, sample.baseColor.z());
+            }
+        }
+    }
+
+    TRACE_SCOPE("TiledRaytracer::shadeTile");
+    for (int row = tile.y; row < tile.y + tile.height; row++) {
+        QRgb *scanline = reinterpret_cast<QRgb *>(frame.bits + row * frame.bytesPerLine);
+        shadeSpan(frame.shading, frame.direction, gBuffer, static_cast<size_t>(row) * frame.width + tile.x, tile.width,
+                  scanline + tile.x);
+    }
+}
+
+void TiledRaytracer::antialiasTile(BRLCAD::ConstDatabase &database, QHash<QString, int> &knownRegionIds,
+                                   const Frame &frame, const Tile &tile) {
+    TRACE_SCOPE("TiledRaytracer::antialiasTile");
+    // the G-buffer is only read in this pass, so the neighbors in other tiles can be looked at
+    Subsamples &subsamples = tileSubsamples[tile.index];
+
+    for (int row = tile.y; row < tile.y + tile.height; row++) {
+        if (tile.imageNumber != imageNumber.load(std::memory_order_relaxed)) return;
+
+        for (int column = tile.x; column < tile.x + tile.width; column++) {
+            if (!isEdge(frame, column, row)) continue;
+
+            for (const float *offset : subsampleOffsets) {
+                subsamples.samples.append(trace(database, knownRegionIds, frame, column + offset[0], row + offset[1]));
+            }
+            subsamples.pixelIndices.push_back(static_cast<size_t>(row) * frame.width + column);
+        }
+    }
+
+    shadeSubsamples(frame, subsamples);
+}
+
+bool TiledRaytracer::isEdge(const Frame &frame, int column, int row) const {
+    const size_t index = static_cast<size_t>(row) * frame.width + column;
+    const int    neighbors[][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    for (const int *neighbor : neighbors) {
+        const int neighborColumn = column + neighbor[0];
+        const int neighborRow    = row + neighbor[1];
+        if (neighborColumn < 0 || neighborColumn >= frame.width || neighborRow < 0 || neighborRow >= frame.height) {
+            continue;
+        }
+
+        const size_t neighborIndex = static_cast<size_t>(neighborRow) * frame.width + neighborColumn;
+        if (gBuffer.regionIds[index] != gBuffer.regionIds[neighborIndex]) return true;
+        // both missed
+        if (gBuffer.regionIds[index] < 0) continue;
+
+        if (std::abs(gBuffer.depths[index] - gBuffer.depths[neighborIndex]) > edgeDepthInPixels * frame.pixelSize) {
+            return true;
+        }
+        const float normalCosine = gBuffer.normalX[index] * gBuffer.normalX[neighborIndex] +
+                                   gBuffer.normalY[index] * gBuffer.normalY[neighborIndex] +
+                                   gBuffer.normalZ[index] * gBuffer.normalZ[neighborIndex];
+        if (normalCosine < edgeNormalCosine) return true;
+    }
+    return false;
+}
+
+TiledRaytracer::Sample TiledRaytracer::trace(BRLCAD::ConstDatabase &database, QHash<QString, int> &knownRegionIds,
+                                             const Frame &frame, float x, float y) {
+    const QVector3D &direction  = frame.direction;
+    QVector3D        imagePoint(x, frame.height - y - 1.f, 0.);
+    QVector3D        modelPoint = frame.transformation.map(imagePoint);
+    Sample           sample{-1, std::numeric_limits<float>::infinity(), QVector3D(), QVector3D()};
+    BRLCAD::Ray3D    ray;
+
+    ray.origin.coordinates[0]    = modelPoint.x();
+    ray.origin.coordinates[1]    = modelPoint.y();
+    ray.origin.coordinates[2]    = modelPoint.z();
+    ray.direction.coordinates[0] = direction.x();
+    ray.direction.coordinates[1] = direction.y();
+    ray.direction.coordinates[2] = direction.z();
+
+    database.ShootRay(ray, [this, &knownRegionIds, &sample](const BRLCAD::ConstDatabase::Hit &hit) {
+        sample.regionId  = regionId(hit.Name(), knownRegionIds);
+        sample.depth     = hit.DistanceIn();
+        sample.normal    = QVector3D(hit.SurfaceNormalIn().coordinates[0], hit.SurfaceNormalIn().coordinates[1],
+                                     hit.SurfaceNormalIn().coordinates[2]);
+        sample.baseColor = QVector3D(hit.Red(), hit.Green(), hit.Blue());
+        return false;
+    }, BRLCAD::ConstDatabase::StopAfterFirstHit);
+
+    return sample;
+}
+
+int TiledRaytracer::regionId(const QString &regionName, QHash<QString, int> &knownRegionIds) {
+    const auto knownRegionId = knownRegionIds.constFind(regionName);
+    if (knownRegionId != knownRegionIds.constEnd()) return knownRegionId.value();
+
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(regionMutex);
+        const auto existingRegionId = regionIds.constFind(regionName);
+        if (existingRegionId != regionIds.constEnd()) {
+            id = existingRegionId.value();
+        } else {
+            id = regionNames.size();
+            regionNames.append(regionName);
+            regionIds.insert(regionName, id);
+        }
+    }
+    knownRegionIds.insert(regionName, id);
+    return id;
+}
+
+void TiledRaytracer::shadeSpan(const Shading &shading, const QVector3D &direction, const GBuffer &gBuffer,
+                               size_t first, int count, QRgb *colors) {
+    int i = 0;
+
+#ifdef TILEDRAYTRACER_SSE2
+    const __m128  zero           = _mm_setzero_ps();
+    const __m128  one            = _mm_set1_ps(1.f);
+    const __m128  two            = _mm_set1_ps(2.f);
+    const __m128  half           = _mm_set1_ps(.5f);
+    const __m128  colorScale     = _mm_set1_ps(255.f);
+    const __m128  directionX     = _mm_set1_ps(direction.x());
+    const __m128  directionY     = _mm_set1_ps(direction.y());
+    const __m128  directionZ     = _mm_set1_ps(direction.z());
+    const __m128  ambient        = _mm_set1_ps(shading.ambient);
+    const __m128  diffuseWeight  = _mm_set1_ps(shading.diffuseWeight);
+    const __m128  specularWeight = _mm_set1_ps(shading.specularWeight);
+    const __m128i background     = _mm_set1_epi32(static_cast<int>(shading.background));
+    const __m128i opaque         = _mm_set1_epi32(static_cast<int>(0xff000000u));
+
+    for (; i + 4 <= count; i += 4) {
+        const size_t index   = first + i;
+        const __m128 normalX = _mm_loadu_ps(gBuffer.normalX.data() + index);
+        const __m128 normalY = _mm_loadu_ps(gBuffer.normalY.data() + index);
+        const __m128 normalZ = _mm_loadu_ps(gBuffer.normalZ.data() + index);
+        __m128       red;
+        __m128       green;
+        __m128       blue;
+
+        if (shading.model == NormalShading) {
+            red   = _mm_mul_ps(_mm_add_ps(normalX, one), half);
+            green = _mm_mul_ps(_mm_add_ps(normalY, one), half);
+            blue  = _mm_mul_ps(_mm_add_ps(normalZ, one), half);
+        } else {
+            // negative because of opposite directions
+            const __m128 dotProduct = _mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, normalX),
+                                                            _mm_mul_ps(directionY, normalY)),
+                                                 _mm_mul_ps(directionZ, normalZ));
+            const __m128 brightness = _mm_sub_ps(ambient, _mm_mul_ps(dotProduct, diffuseWeight));
+            __m128       specular   = zero;
+
+            if (shading.model == PhongShading) {
+                // reflected = incidence - 2 normal
+                const __m128 twoDot     = _mm_mul_ps(two, dotProduct);
+                const __m128 reflectedX = _mm_sub_ps(directionX, _mm_mul_ps(twoDot, normalX));
+                const __m128 reflectedY = _mm_sub_ps(directionY, _mm_mul_ps(twoDot, normalY));
+                const __m128 reflectedZ = _mm_sub_ps(directionZ, _mm_mul_ps(twoDot, normalZ));
+                const __m128 length     = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(reflectedX, reflectedX),
+                                                                            _mm_mul_ps(reflectedY, reflectedY)),
+                                                                 _mm_mul_ps(reflectedZ, reflectedZ)));
+                const __m128 reflectedDotCamDir = _mm_max_ps(zero, _mm_div_ps(
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(reflectedX, directionX), _mm_mul_ps(reflectedY, directionY)),
+                               _mm_mul_ps(reflectedZ, directionZ)),
+                    _mm_max_ps(length, _mm_set1_ps(1e-12f))));
+
+                __m128 power = one;
+                __m128 base  = reflectedDotCamDir;
+                for (int exponent = shading.shininess; exponent > 0; exponent >>= 1) {
+                    if (exponent & 1) power = _mm_mul_ps(power, base);
+                    base = _mm_mul_ps(base, base);
+                }
+                specular = _mm_mul_ps(power, specularWeight);
+            }
+
+            red   = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gBuffer.red.data() + index), brightness), specular);
+            green = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gBuffer.green.data() + index), brightness), specular);
+            blue  = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gBuffer.blue.data() + index), brightness), specular);
+        }
+
+        const __m128i redBytes   = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(red, zero), one),
+                                                                          colorScale), half));
+        const __m128i greenBytes = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(green, zero), one),
+                                                                          colorScale), half));
+        const __m128i blueBytes  = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(blue, zero), one),
+                                                                          colorScale), half));
+        const __m128i shaded     = _mm_or_si128(_mm_or_si128(opaque, _mm_slli_epi32(redBytes, 16)),
+                                                _mm_or_si128(_mm_slli_epi32(greenBytes, 8), blueBytes));
+
+        const __m128i regionIds  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(gBuffer.regionIds.data() + index));
+        const __m128i missed     = _mm_cmplt_epi32(regionIds, _mm_setzero_si128());
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(colors + i),
+                         _mm_or_si128(_mm_and_si128(missed, background), _mm_andnot_si128(missed, shaded)));
+    }
+#endif
+
+    // the pixels left over, or all of them without SSE2
+    for (; i < count; i++) {
+        const size_t index = first + i;
+        if (gBuffer.regionIds[index] < 0) {
+            colors[i] = shading.background;
+            continue;
+        }
+        colors[i] = shadePixel(shading, direction, QVector3D(gBuffer.normalX[index], gBuffer.normalY[index],
+                                                             gBuffer.normalZ[index]),
+                               QVector3D(gBuffer.red[index], gBuffer.green[index], gBuffer.blue[index]));
+    }
+}
+
+void TiledRaytracer::shadeSubsamples(const Frame &frame, const Subsamples &subsamples) {
+    const int sampleCount = static_cast<int>(subsamples.pixelIndices.size()) * SUBSAMPLE_COUNT;
+    if (sampleCount == 0) return;
+
+    std::vector<QRgb> colors(sampleCount);
+    shadeSpan(frame.shading, frame.direction, subsamples.samples, 0, sampleCount, colors.data());
+
+    for (size_t i = 0; i < subsamples.pixelIndices.size(); i++) {
+        int red   = 0;
+        int green = 0;
+        int blue  = 0;
+        for (int j = 0; j < SUBSAMPLE_COUNT; j++) {
+            const QRgb color = colors[i * SUBSAMPLE_COUNT + j];
+            red   += qRed(color);
+            green += qGreen(color);
+            blue  += qBlue(color);
+        }
+
+        const size_t pixelIndex = subsamples.pixelIndices[i];
+        const int    row        = static_cast<int>(pixelIndex / frame.width);
+        const int    column     = static_cast<int>(pixelIndex % frame.width);
+        QRgb *scanline = reinterpret_cast<QRgb *>(frame.bits + row * frame.bytesPerLine);
+        scanline[column] = qRgb((red + SUBSAMPLE_COUNT / 2) / SUBSAMPLE_COUNT,
+                                (green + SUBSAMPLE_COUNT / 2) / SUBSAMPLE_COUNT,
+                                (blue + SUBSAMPLE_COUNT / 2) / SUBSAMPLE_COUNT);
+    }
+}
+
+void TiledRaytracer::GBuffer::append(const Sample &sample) {
+    regionIds.push_back(sample.regionId);
+    depths.push_back(sample.depth);
+    normalX.push_back(sample.normal.x());
+    normalY.push_back(sample.normal.y());
+    normalZ.push_back(sample.normal.z());
+    red.push_back(sample.baseColor.x());
+    green.push_back(sample.baseColor.y());
+    blue.push_back(sample.baseColor.z());
+}
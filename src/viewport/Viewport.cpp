@@ -22,12 +22,15 @@
 #include "Viewport.h"
 
 #include <iostream>
+#include <QPainter>
 #include <QScreen>
+#include <QSettings>
 #include <QWidget>
 #include <OrthographicCamera.h>
 #include <include/Globals.h>
 #include "ViewportManager.h"
 #include "GeometryRenderer.h"
+#include "RepaintScheduler.h"
 #include "Utils.h"
 
 using namespace std;
@@ -43,20 +46,62 @@ Viewport::Viewport(Document*  document)
     bgColor = Globals::theme->getColor("$Color-GraphicsView");
     displayManager->setBGColor(bgColor.redF(),bgColor.greenF(),bgColor.blueF());
 
+    QSettings settings("BRLCAD", "arbalest");
+    reduceDetailWhileMoving = settings.value("reduceDetailWhileMoving", true).toBool();
+    interactionIdleTimer.setSingleShot(true);
+    interactionIdleTimer.setInterval(INTERACTION_IDLE_MS);
+    QObject::connect(&interactionIdleTimer, &QTimer::timeout, this, [this]() {
+        endInteraction();
+    });
+
     makeCurrent();
     update();
 }
 
 Viewport::~Viewport() {
+    // the shader pipeline of the viewport manager holds objects of this context
+    makeCurrent();
     delete camera;
+    delete frameStatistics;
     delete displayManager;
     delete axesRenderer;
 }
 
 
+// hidden viewports are skipped and bursts of requests are coalesced into one repaint per display refresh
 void Viewport::forceRerenderFrame() {
-    makeCurrent();
-    update();
+    Globals::repaintScheduler->requestRepaint(this);
+}
+
+void Viewport::renderFrame(const int w, const int h) {
+    camera->setWH(w, h);
+    this->w = w;
+    this->h = h;
+    paintGL();
+}
+
+/*
+ * Once reduced, the detail stays reduced until the interaction ends, otherwise the fast reduced frames would switch
+ * back to full detail every other frame.
+ */
+void Viewport::interact() {
+    interacting = true;
+    // GPU bound frames return from paintGL() early, so their GPU time counts too
+    if (reduceDetailWhileMoving && frameStatistics != nullptr &&
+        frameStatistics->latestFullDetailFrameMs() > INTERACTIVE_FRAME_MS) {
+        reducedDetail = true;
+    }
+    interactionIdleTimer.start();
+}
+
+void Viewport::endInteraction() {
+    interactionIdleTimer.stop();
+    if (!interacting) return;
+    interacting = false;
+    if (reducedDetail) {
+        reducedDetail = false;
+        forceRerenderFrame();
+    }
 }
 
 int Viewport::getW() const {
@@ -87,12 +132,24 @@ void Viewport::resizeGL(const int w, const int h) {
 }
 
 void Viewport::paintGL() {
+    // measured with the overlay off too, see interact()
+    if (frameStatistics == nullptr) frameStatistics = new FrameStatistics();
+    frameStatistics->beginFrame(*Globals::geometryCache, reducedDetail);
+
     displayManager->drawBegin();
 
     glViewport(0,0,w,h);
+    const QMatrix4x4 viewProjection = camera->projectionMatrix() * camera->modelViewMatrix();
+    if (viewProjection != paintedViewProjection) {
+        paintedViewProjection = viewProjection;
+        // an open raytrace window follows the active viewport
+        if (document->getViewport() == this && document->getRaytraceWidget() != nullptr) {
+            document->getRaytraceWidget()->viewportCameraChanged();
+        }
+    }
     displayManager->loadMatrix(camera->modelViewMatrix().data());
     displayManager->loadPMatrix(camera->projectionMatrix().data());
-    document->getGeometryRenderer()->render();
+    document->getGeometryRenderer()->render(this);
     if(gridEnabled)gridRenderer->render();
 
     glViewport(w*.88,h*.02,w/10,w/10);
@@ -101,24 +158,36 @@ void Viewport::paintGL() {
     orthoMtx.ortho(-100.f, 100.f, -100.0f, 100.0f, -1000.f,1000.f);
     displayManager->loadPMatrix(orthoMtx.data());
     axesRenderer->render();
+
+    GeometryRenderer *geometryRenderer = document->getGeometryRenderer();
+    frameStatistics->endFrame(*Globals::geometryCache, geometryRenderer->getDrawnObjectCount(),
+                              geometryRenderer->getCulledObjectCount(), geometryRenderer->getOccludedObjectCount());
+    if (statisticsEnabled) {
+        QPainter painter(this);
+        frameStatistics->paint(painter);
+    }
 }
 
 void Viewport::keyPressEvent( QKeyEvent *k ) {
     switch (k->key()) {
         case Qt::Key_Up:
             camera->processMoveRequest(0, keyPressSimulatedMouseMoveDistance);
+            interact();
             forceRerenderFrame();
             break;
         case Qt::Key_Down:
             camera->processMoveRequest(0, -keyPressSimulatedMouseMoveDistance);
+            interact();
             forceRerenderFrame();
             break;
         case Qt::Key_Left:
             camera->processMoveRequest(keyPressSimulatedMouseMoveDistance, 0);
+            interact();
             forceRerenderFrame();
             break;
         case Qt::Key_Right:
             camera->processMoveRequest(-keyPressSimulatedMouseMoveDistance, 0);
+            interact();
             forceRerenderFrame();
             break;
     }
@@ -21,6 +21,7 @@
 
 #include <QMatrix4x4>
 #include <QScreen>
+#include <QSettings>
 #include "ViewportManager.h"
 
 #define DM_SOLID_LINE 0
@@ -33,8 +34,37 @@ ViewportManager::ViewportManager(Viewport &display) : display(display)
     glLineStipple(1, 0xCF33);
 }
 
+ViewportManager::~ViewportManager()
+{
+    delete shaderPipeline;
+    delete occlusionCuller;
+}
+
+ShaderPipeline *ViewportManager::getShaderPipeline()
+{
+    if (!shaderPipelineInitialized) {
+        shaderPipelineInitialized = true;
+        QSettings settings("BRLCAD", "arbalest");
+        if (settings.value("shaderPipeline", true).toBool()) {
+            shaderPipeline = new ShaderPipeline();
+            if (!shaderPipeline->isValid()) {
+                delete shaderPipeline;
+                shaderPipeline = nullptr;
+            }
+        }
+    }
+    // the axes load their own matrices every frame, so the camera is compared with what the shaders have
+    if (shaderPipeline != nullptr && (!cameraUploaded || modelViewMatrix != uploadedModelViewMatrix ||
+                                      projectionMatrix != uploadedProjectionMatrix)) {
+        shaderPipeline->setCamera(modelViewMatrix, projectionMatrix);
+        uploadedModelViewMatrix = modelViewMatrix;
+        uploadedProjectionMatrix = projectionMatrix;
+        cameraUploaded = true;
+    }
+    return shaderPipeline;
+}
+
 bool ViewportManager::DrawVListElementCallback::operator()(BRLCAD::VectorList::Element *element) {
-    const  float black[4] = {0.0, 0.0, 0.0, 0.0};
     if (!element) return true;
 
     switch (element->Type()) {
@@ -51,12 +81,7 @@ bool ViewportManager::DrawVListElementCallback::operator()(BRLCAD::VectorList::E
 
             if (displayManager->dmLight && vars->mFlag) {
                 vars->mFlag = 0;
-                glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, displayManager->wireColor);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, black);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, black);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, black);
-
-                if (displayManager->dmTransparency) glDisable(GL_BLEND);
+                displayManager->setWireMaterial();
             }
 
             glBegin(GL_LINE_STRIP);
@@ -98,27 +123,7 @@ bool ViewportManager::DrawVListElementCallback::operator()(BRLCAD::VectorList::E
             BRLCAD::VectorList::PolygonStart *e = dynamic_cast<BRLCAD::VectorList::PolygonStart *> (element);
             if (displayManager->dmLight && vars->mFlag) {
                 vars->mFlag = 0;
-                glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, black);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, displayManager->ambientColor);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, displayManager->specularColor);
-                glMaterialfv(GL_FRONT, GL_DIFFUSE, displayManager->diffuseColor);
-
-                switch (displayManager->dmLight) {
-                    case 1:
-                        break;
-                    case 2:
-                        glMaterialfv(GL_BACK, GL_DIFFUSE, displayManager->diffuseColor);
-                        break;
-                    case 3:
-                        glMaterialfv(GL_BACK, GL_DIFFUSE, displayManager->backDiffuseColorDark);
-                        break;
-                    default:
-                        glMaterialfv(GL_BACK, GL_DIFFUSE, displayManager->backDiffuseColorLight);
-                        break;
-                }
-
-                if (displayManager->dmTransparency)
-                    glEnable(GL_BLEND);
+                displayManager->setSurfaceMaterial();
             }
 
             if (vars->first == 0) glEnd();
@@ -133,27 +138,7 @@ bool ViewportManager::DrawVListElementCallback::operator()(BRLCAD::VectorList::E
             BRLCAD::VectorList::TriangleStart *e = dynamic_cast<BRLCAD::VectorList::TriangleStart *> (element);
             if (displayManager->dmLight && vars->mFlag) {
                 vars->mFlag = 0;
-                glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, black);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, displayManager->ambientColor);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, displayManager->specularColor);
-                glMaterialfv(GL_FRONT, GL_DIFFUSE, displayManager->diffuseColor);
-
-                switch (displayManager->dmLight) {
-                    case 1:
-                        break;
-                    case 2:
-                        glMaterialfv(GL_BACK, GL_DIFFUSE, displayManager->diffuseColor);
-                        break;
-                    case 3:
-                        glMaterialfv(GL_BACK, GL_DIFFUSE, displayManager->backDiffuseColorDark);
-                        break;
-                    default:
-                        glMaterialfv(GL_BACK, GL_DIFFUSE, displayManager->backDiffuseColorLight);
-                        break;
-                }
-
-                if (displayManager->dmTransparency)
-                    glEnable(GL_BLEND);
+                displayManager->setSurfaceMaterial();
             }
 
             if (vars->first) {
@@ -260,6 +245,170 @@ void ViewportManager::drawVList(BRLCAD::VectorList *vectorList)
 }
 
 
+/*
+ * Draw objects uploaded to `geometryCache` using the current foreground color.
+ * All entries have to be in the same page of the cache.
+ * These are the buffer based counterpart of drawVList: lines and points are drawn with the wire material and
+ * triangles with the lit surface material.
+ */
+void ViewportManager::drawWireGeometry(GeometryCache &geometryCache, const QVector<const GeometryCache::Entry *> &entries)
+{
+    if (entries.isEmpty()) return;
+
+    if (getShaderPipeline() != nullptr) {
+        shaderPipeline->drawWires(geometryCache, entries, wireColor);
+        return;
+    }
+    // compact vertices are decoded by the shader
+    if (entries.first()->vertexFormat != GeometryCache::FloatVertices) return;
+
+    geometryCache.bindPage(entries.first()->page);
+    if (dmLight) {
+        glEnable(GL_LIGHTING);
+        setWireMaterial();
+    }
+    geometryCache.draw(GeometryData::Lines, entries);
+    geometryCache.draw(GeometryData::Points, entries);
+}
+
+void ViewportManager::drawSurfaceGeometry(GeometryCache &geometryCache, const QVector<const GeometryCache::Entry *> &entries)
+{
+    if (entries.isEmpty()) return;
+
+    if (getShaderPipeline() != nullptr) {
+        shaderPipeline->drawSurfaces(geometryCache, entries, diffuseColor, ambientColor, backDiffuseColor());
+        return;
+    }
+    if (entries.first()->vertexFormat != GeometryCache::FloatVertices) return;
+
+    geometryCache.bindPage(entries.first()->page);
+    if (dmLight) {
+        glEnable(GL_LIGHTING);
+        setSurfaceMaterial();
+    }
+    geometryCache.draw(GeometryData::Triangles, entries);
+
+    if (dmLight && dmTransparency)
+        glDisable(GL_BLEND);
+}
+
+/*
+ * Without the shader pipeline every placement is a draw of its own.
+ */
+void ViewportManager::drawWireGeometry(GeometryCache &geometryCache, const GeometryCache::Entry *entry,
+                                       const QVector<QMatrix4x4> &placements)
+{
+    if (getShaderPipeline() != nullptr) {
+        shaderPipeline->drawWires(geometryCache, *entry, placements, wireColor);
+        return;
+    }
+    for (const QMatrix4x4 &placement : placements) {
+        pushMatrix(placement.constData());
+        drawWireGeometry(geometryCache, {entry});
+        popMatrix();
+    }
+}
+
+void ViewportManager::drawSurfaceGeometry(GeometryCache &geometryCache, const GeometryCache::Entry *entry,
+                                          const QVector<QMatrix4x4> &placements)
+{
+    if (getShaderPipeline() != nullptr) {
+        shaderPipeline->drawSurfaces(geometryCache, *entry, placements, diffuseColor, ambientColor,
+                                     backDiffuseColor());
+        return;
+    }
+    for (const QMatrix4x4 &placement : placements) {
+        pushMatrix(placement.constData());
+        drawSurfaceGeometry(geometryCache, {entry});
+        popMatrix();
+    }
+}
+
+// the color of back faces in the current lighting mode
+const float *ViewportManager::backDiffuseColor() const
+{
+    if (dmLight == 3) return backDiffuseColorDark;
+    if (dmLight != 1 && dmLight != 2) return backDiffuseColorLight;
+    return diffuseColor;
+}
+
+void ViewportManager::finishGeometry(GeometryCache &geometryCache)
+{
+    if (shaderPipeline != nullptr) {
+        shaderPipeline->release(geometryCache);
+    }
+    else {
+        geometryCache.unbind();
+    }
+}
+
+bool ViewportManager::hasShaderPipeline()
+{
+    return getShaderPipeline() != nullptr;
+}
+
+OcclusionCuller *ViewportManager::getOcclusionCuller()
+{
+    if (!occlusionCullerInitialized) {
+        occlusionCullerInitialized = true;
+        QSettings settings("BRLCAD", "arbalest");
+        if (settings.value("occlusionCulling", true).toBool()) {
+            occlusionCuller = new OcclusionCuller();
+            if (!occlusionCuller->isValid()) {
+                delete occlusionCuller;
+                occlusionCuller = nullptr;
+            }
+        }
+    }
+    return occlusionCuller;
+}
+
+bool ViewportManager::drawGrid(float spacing, float halfLength, const float color[4])
+{
+    if (getShaderPipeline() == nullptr) return false;
+
+    shaderPipeline->drawGrid(spacing, halfLength, color);
+    return true;
+}
+
+void ViewportManager::setWireMaterial() const
+{
+    const float black[4] = {0.0, 0.0, 0.0, 0.0};
+    glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, wireColor);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, black);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, black);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, black);
+
+    if (dmTransparency) glDisable(GL_BLEND);
+}
+
+void ViewportManager::setSurfaceMaterial() const
+{
+    const float black[4] = {0.0, 0.0, 0.0, 0.0};
+    glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, black);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, ambientColor);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specularColor);
+    glMaterialfv(GL_FRONT, GL_DIFFUSE, diffuseColor);
+
+    switch (dmLight) {
+        case 1:
+            break;
+        case 2:
+            glMaterialfv(GL_BACK, GL_DIFFUSE, diffuseColor);
+            break;
+        case 3:
+            glMaterialfv(GL_BACK, GL_DIFFUSE, backDiffuseColorDark);
+            break;
+        default:
+            glMaterialfv(GL_BACK, GL_DIFFUSE, backDiffuseColorLight);
+            break;
+    }
+
+    if (dmTransparency)
+        glEnable(GL_BLEND);
+}
+
+
 void ViewportManager::setFGColor(float r, float g, float b, float transparency) {
     wireColor[0] = r;
     wireColor[1] = g;
@@ -412,12 +561,40 @@ void ViewportManager::loadMatrix(const GLfloat *m)
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
     glLoadMatrixf(m);
+    // column major, like OpenGL
+    modelViewMatrix = QMatrix4x4(m).transposed();
 }
 void ViewportManager::loadPMatrix(const GLfloat *m)
 {
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     glLoadMatrixf(m);
+    projectionMatrix = QMatrix4x4(m).transposed();
+}
+
+void ViewportManager::pushMatrix(const GLfloat *m)
+{
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glMultMatrixf(m);
+    // placement matrices may scale
+    glEnable(GL_NORMALIZE);
+
+    const QMatrix4x4 matrix = QMatrix4x4(m).transposed();
+    placementMatrixStack.append(placementMatrixStack.isEmpty() ? matrix : placementMatrixStack.last() * matrix);
+    // the pipeline may not exist yet before the first draw of the viewport
+    if (getShaderPipeline() != nullptr) shaderPipeline->setPlacementMatrix(placementMatrixStack.last());
+}
+void ViewportManager::popMatrix()
+{
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glDisable(GL_NORMALIZE);
+
+    placementMatrixStack.removeLast();
+    if (getShaderPipeline() != nullptr) {
+        shaderPipeline->setPlacementMatrix(placementMatrixStack.isEmpty() ? QMatrix4x4() : placementMatrixStack.last());
+    }
 }
 
 void ViewportManager::setSuffix(const BRLCAD::VectorList& vectorList) {